@@ -5,6 +5,8 @@
 #include <zephyr/bluetooth/conn.h>
 #include <zephyr/bluetooth/addr.h>
 
+#include "cb_timing.h"
+
 LOG_MODULE_REGISTER(addr_test, LOG_LEVEL_INF);
 
 #define DEVICE_NAME CONFIG_BT_DEVICE_NAME
@@ -21,17 +23,23 @@ static struct bt_conn *my_conn = NULL;
 
 void on_connected(struct bt_conn *conn, uint8_t err)
 {
+	uint32_t t = cb_timing_start();
+
 	if (err)
 	{
 		LOG_ERR("Connection failed (err %u)", err);
+		cb_timing_end("connected", t);
 		return;
 	}
 
 	my_conn = bt_conn_ref(conn);
+	cb_timing_end("connected", t);
 }
 
 void on_disconnected(struct bt_conn *conn, uint8_t reason)
 {
+	uint32_t t = cb_timing_start();
+
 	LOG_INF("Disconnected (reason 0x%02x)", reason);
 
 	if (my_conn)
@@ -39,6 +47,9 @@ void on_disconnected(struct bt_conn *conn, uint8_t reason)
 		bt_conn_unref(my_conn);
 		my_conn = NULL;
 	}
+
+	cb_timing_end("disconnected", t);
+	cb_timing_print(); // see ../common/cb_timing.conf
 }
 
 static struct bt_conn_cb connection_callbacks = {
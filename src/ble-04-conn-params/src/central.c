@@ -0,0 +1,287 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <string.h>
+
+#include "tput_service.h"
+
+LOG_MODULE_REGISTER(tput_central, LOG_LEVEL_INF);
+
+/* Built instead of the peripheral with overlay-bsim-central.conf: the
+ * central of the BabbleSim throughput run. Scans for the peripheral by
+ * name, connects with the stack's default parameters, finds the
+ * throughput service and enables notifications, which starts a test as
+ * soon as the peripheral is done tuning. Counts the data it receives, and
+ * when the result comes in prints both sides' goodput, disconnects and
+ * connects again, CONFIG_APP_TPUT_CENTRAL_RUNS times. With
+ * CONFIG_APP_TUNER_CYCLE on the peripheral, every run is another profile.
+ *
+ * With CONFIG_APP_TPUT_CENTRAL_BURSTS above 1, a run is several tests on
+ * the same connection with CONFIG_APP_TPUT_CENTRAL_IDLE_MS of silence in
+ * between, each started by writing its duration to Result: traffic that
+ * comes and goes, for the peripheral's load-adaptive parameters. See
+ * overlay-bsim-bursts.conf.
+ *
+ * Does nothing on its own about PHY, data length or MTU, so what the link
+ * gets is the peripheral tuner's doing.
+ */
+
+#define PEER_NAME CONFIG_APP_TPUT_PEER_NAME
+#define RESULT_LEN 12
+
+static struct bt_conn *conn;
+static int runs;
+
+static struct bt_gatt_discover_params discover_params;
+static struct bt_gatt_subscribe_params data_sub;
+static struct bt_gatt_subscribe_params result_sub;
+static uint16_t data_handle;
+static uint16_t result_handle;
+
+static uint32_t rx_bytes;
+static int64_t start_ms; /* test asked for */
+static int64_t first_rx_ms;
+static int64_t last_rx_ms;
+static int bursts;
+
+static struct bt_gatt_write_params write_params;
+static uint8_t burst_value[sizeof(uint32_t)];
+
+static void next_burst_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(next_burst_work, next_burst_handler);
+
+static void start_scan(void);
+
+static bool name_matches(struct bt_data *data, void *user_data)
+{
+	bool *found = user_data;
+
+	if (data->type == BT_DATA_NAME_COMPLETE && data->data_len == sizeof(PEER_NAME) - 1 &&
+	    memcmp(data->data, PEER_NAME, data->data_len) == 0) {
+		*found = true;
+		return false;
+	}
+	return true;
+}
+
+static void device_found(const bt_addr_le_t *addr, int8_t rssi, uint8_t type,
+			 struct net_buf_simple *ad)
+{
+	bool found = false;
+
+	if (conn || type != BT_GAP_ADV_TYPE_ADV_IND) {
+		return;
+	}
+
+	bt_data_parse(ad, name_matches, &found);
+	if (!found || bt_le_scan_stop()) {
+		return;
+	}
+
+	int err = bt_conn_le_create(addr, BT_CONN_LE_CREATE_CONN, BT_LE_CONN_PARAM_DEFAULT, &conn);
+	if (err) {
+		LOG_ERR("Create connection failed (%d)", err);
+		start_scan();
+	}
+}
+
+static void start_scan(void)
+{
+	int err = bt_le_scan_start(BT_LE_SCAN_PASSIVE, device_found);
+	if (err) {
+		LOG_ERR("Scan start failed (%d)", err);
+	}
+}
+
+static uint8_t on_data(struct bt_conn *c, struct bt_gatt_subscribe_params *params,
+		       const void *data, uint16_t length)
+{
+	if (!data) {
+		return BT_GATT_ITER_STOP;
+	}
+
+	last_rx_ms = k_uptime_get();
+	if (rx_bytes == 0) {
+		first_rx_ms = last_rx_ms;
+	}
+	rx_bytes += length;
+	return BT_GATT_ITER_CONTINUE;
+}
+
+static uint8_t on_result(struct bt_conn *c, struct bt_gatt_subscribe_params *params,
+			 const void *data, uint16_t length)
+{
+	if (!data) {
+		return BT_GATT_ITER_STOP;
+	}
+	if (length != RESULT_LEN) {
+		return BT_GATT_ITER_CONTINUE;
+	}
+
+	const uint8_t *value = data;
+	uint32_t rx_ms = MAX((uint32_t)(last_rx_ms - first_rx_ms), 1);
+
+	/* start_ms: from asking for the test to its first data, what a
+	 * request to a device in its idle parameters waits
+	 */
+	printk("{\"run\":%d,\"burst\":%d,\"start_ms\":%u,\"rx_bytes\":%u,\"rx_ms\":%u,"
+	       "\"rx_kbps\":%u,\"peer_bytes\":%u,\"peer_ms\":%u,\"peer_kbps\":%u}\n",
+	       runs + 1, bursts + 1, (uint32_t)(first_rx_ms - start_ms), rx_bytes, rx_ms,
+	       (uint32_t)((uint64_t)rx_bytes * 8 / rx_ms), sys_get_le32(&value[0]),
+	       sys_get_le32(&value[4]), sys_get_le32(&value[8]));
+
+	if (++bursts < CONFIG_APP_TPUT_CENTRAL_BURSTS) {
+		k_work_reschedule(&next_burst_work, K_MSEC(CONFIG_APP_TPUT_CENTRAL_IDLE_MS));
+		return BT_GATT_ITER_CONTINUE;
+	}
+
+	bt_conn_disconnect(c, BT_HCI_ERR_REMOTE_USER_TERM_CONN);
+	return BT_GATT_ITER_CONTINUE;
+}
+
+static void on_burst_written(struct bt_conn *c, uint8_t err, struct bt_gatt_write_params *params)
+{
+	if (err) {
+		LOG_ERR("Test start write failed (ATT err %u)", err);
+		bt_conn_disconnect(c, BT_HCI_ERR_REMOTE_USER_TERM_CONN);
+	}
+}
+
+/* Idle time over, ask for the next test */
+static void next_burst_handler(struct k_work *work)
+{
+	if (!conn) {
+		return;
+	}
+
+	rx_bytes = 0;
+	start_ms = k_uptime_get();
+	sys_put_le32(CONFIG_APP_TPUT_CENTRAL_BURST_MS, burst_value);
+
+	write_params.func = on_burst_written;
+	write_params.handle = result_handle;
+	write_params.offset = 0;
+	write_params.data = burst_value;
+	write_params.length = sizeof(burst_value);
+
+	int err = bt_gatt_write(conn, &write_params);
+	if (err) {
+		LOG_ERR("Test start write failed (%d)", err);
+		bt_conn_disconnect(conn, BT_HCI_ERR_REMOTE_USER_TERM_CONN);
+	}
+}
+
+static void subscribe(struct bt_gatt_subscribe_params *params, uint16_t handle,
+		      bt_gatt_notify_func_t notify)
+{
+	memset(params, 0, sizeof(*params));
+	params->notify = notify;
+	params->value = BT_GATT_CCC_NOTIFY;
+	params->value_handle = handle;
+	/* The service puts each CCC right after its value */
+	params->ccc_handle = handle + 1;
+
+	int err = bt_gatt_subscribe(conn, params);
+	if (err) {
+		LOG_ERR("Subscribe failed (%d)", err);
+	}
+}
+
+static uint8_t discover_func(struct bt_conn *c, const struct bt_gatt_attr *attr,
+			     struct bt_gatt_discover_params *params)
+{
+	if (!attr) {
+		if (!data_handle || !result_handle) {
+			LOG_ERR("Throughput service not found");
+			bt_conn_disconnect(c, BT_HCI_ERR_REMOTE_USER_TERM_CONN);
+			return BT_GATT_ITER_STOP;
+		}
+
+		/* Result first, the data subscription starts the test */
+		start_ms = k_uptime_get();
+		subscribe(&result_sub, result_handle, on_result);
+		subscribe(&data_sub, data_handle, on_data);
+		return BT_GATT_ITER_STOP;
+	}
+
+	const struct bt_gatt_chrc *chrc = attr->user_data;
+
+	if (bt_uuid_cmp(chrc->uuid, BT_UUID_TPUT_DATA) == 0) {
+		data_handle = chrc->value_handle;
+	} else if (bt_uuid_cmp(chrc->uuid, BT_UUID_TPUT_RESULT) == 0) {
+		result_handle = chrc->value_handle;
+	}
+	return BT_GATT_ITER_CONTINUE;
+}
+
+static void on_connected(struct bt_conn *c, uint8_t err)
+{
+	if (err) {
+		LOG_ERR("Failed to connect (err %u)", err);
+		bt_conn_unref(conn);
+		conn = NULL;
+		start_scan();
+		return;
+	}
+
+	rx_bytes = 0;
+	bursts = 0;
+	data_handle = 0;
+	result_handle = 0;
+
+	discover_params.uuid = NULL;
+	discover_params.func = discover_func;
+	discover_params.start_handle = BT_ATT_FIRST_ATTRIBUTE_HANDLE;
+	discover_params.end_handle = BT_ATT_LAST_ATTRIBUTE_HANDLE;
+	discover_params.type = BT_GATT_DISCOVER_CHARACTERISTIC;
+
+	err = bt_gatt_discover(conn, &discover_params);
+	if (err) {
+		LOG_ERR("Discovery failed (%d)", err);
+		bt_conn_disconnect(c, BT_HCI_ERR_REMOTE_USER_TERM_CONN);
+	}
+}
+
+static void on_disconnected(struct bt_conn *c, uint8_t reason)
+{
+	k_work_cancel_delayable(&next_burst_work);
+	if (conn) {
+		bt_conn_unref(conn);
+		conn = NULL;
+	}
+	runs++;
+}
+
+/* Connection object free again, next run or done */
+static void on_recycled(void)
+{
+	if (runs < CONFIG_APP_TPUT_CENTRAL_RUNS) {
+		start_scan();
+	} else {
+		printk("Throughput runs done: %d\n", runs);
+	}
+}
+
+static struct bt_conn_cb conn_callbacks = {
+	.connected = on_connected,
+	.disconnected = on_disconnected,
+	.recycled = on_recycled,
+};
+
+void main(void)
+{
+	if (bt_conn_cb_register(&conn_callbacks)) {
+		LOG_ERR("Failed to register BLE callbacks");
+		return;
+	}
+
+	if (bt_enable(NULL)) {
+		LOG_ERR("Bluetooth init failed");
+		return;
+	}
+
+	start_scan();
+}
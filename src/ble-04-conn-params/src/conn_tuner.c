@@ -0,0 +1,329 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/gap.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <string.h>
+
+#include "conn_tuner.h"
+
+LOG_MODULE_REGISTER(conn_tuner, LOG_LEVEL_INF);
+
+#define STEP_TIMEOUT K_MSEC(CONFIG_APP_TUNER_STEP_TIMEOUT_MS)
+#define RETRY_DELAY K_MSEC(100)
+#define ATT_DEFAULT_MTU 23
+#define INTERVAL_MAX 3200 /* 4 s */
+
+static const char *const step_names[] = {"phy", "dle", "mtu", "interval"};
+
+static struct {
+	struct bt_conn *conn;
+	conn_tuner_done_cb_t done;
+	enum conn_tuner_step step;
+	bool waiting;  /* a request of 'step' is out */
+	bool relaxed;  /* interval step, asking for the wider range */
+	uint8_t mtu_err;
+	int64_t start_ms;
+	struct conn_tuner_result result;
+} tuner;
+
+/* Set by the callbacks, one bit per step. The work handler owns everything
+ * else.
+ */
+static atomic_t events;
+
+static void step_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(step_work, step_work_handler);
+
+static void mtu_exchange_cb(struct bt_conn *conn, uint8_t err, struct bt_gatt_exchange_params *params)
+{
+	tuner.mtu_err = err;
+	atomic_set_bit(&events, CONN_TUNER_MTU);
+	k_work_reschedule(&step_work, K_NO_WAIT);
+}
+
+static struct bt_gatt_exchange_params mtu_params = {
+	.func = mtu_exchange_cb,
+};
+
+static void interval_range(uint16_t *min, uint16_t *max)
+{
+	const struct conn_tuner_profile *p = tuner.result.profile;
+
+	*min = p->interval_min;
+	*max = tuner.relaxed ? MIN(p->interval_max * 2, INTERVAL_MAX) : p->interval_max;
+}
+
+static int request(enum conn_tuner_step step)
+{
+	const struct conn_tuner_profile *p = tuner.result.profile;
+
+	switch (step) {
+	case CONN_TUNER_PHY: {
+		const struct bt_conn_le_phy_param param = {
+			.options = BT_CONN_LE_PHY_OPT_NONE,
+			.pref_tx_phy = p->phy,
+			.pref_rx_phy = p->phy,
+		};
+		return bt_conn_le_phy_update(tuner.conn, &param);
+	}
+	case CONN_TUNER_DLE: {
+		const struct bt_conn_le_data_len_param param = {
+			.tx_max_len = p->tx_len,
+			/* Long enough for the payload on the slowest PHY in use */
+			.tx_max_time = BT_GAP_DATA_TIME_MAX,
+		};
+		return bt_conn_le_data_len_update(tuner.conn, &param);
+	}
+	case CONN_TUNER_MTU:
+		return bt_gatt_exchange_mtu(tuner.conn, &mtu_params);
+	case CONN_TUNER_INTERVAL: {
+		uint16_t min, max;
+
+		interval_range(&min, &max);
+		return bt_conn_le_param_update(tuner.conn, BT_LE_CONN_PARAM(min, max, 0, 400));
+	}
+	default:
+		return -EINVAL;
+	}
+}
+
+static bool skipped(enum conn_tuner_step step)
+{
+	const struct conn_tuner_profile *p = tuner.result.profile;
+
+	switch (step) {
+	case CONN_TUNER_PHY:
+		return p->phy == 0;
+	case CONN_TUNER_DLE:
+		return p->tx_len == 0;
+	case CONN_TUNER_MTU:
+		return !p->mtu;
+	default:
+		return p->interval_min == 0;
+	}
+}
+
+/* Reads the link as it is now, for steps whose answer may never come: a
+ * controller only reports a data length or interval that changed
+ */
+static void read_link(void)
+{
+	struct bt_conn_info info;
+
+	if (bt_conn_get_info(tuner.conn, &info) == 0) {
+		tuner.result.tx_phy = info.le.phy->tx_phy;
+		tuner.result.rx_phy = info.le.phy->rx_phy;
+		tuner.result.tx_len = info.le.data_len->tx_max_len;
+		tuner.result.rx_len = info.le.data_len->rx_max_len;
+		tuner.result.interval = info.le.interval;
+		tuner.result.latency = info.le.latency;
+		tuner.result.timeout = info.le.timeout;
+	}
+	tuner.result.mtu = bt_gatt_get_mtu(tuner.conn);
+}
+
+/* The outcome of the current step once it was answered, or the link
+ * already is where the step wants it
+ */
+static bool evaluate(enum conn_tuner_step step, bool answered, enum conn_tuner_outcome *outcome)
+{
+	const struct conn_tuner_profile *p = tuner.result.profile;
+	struct conn_tuner_result *r = &tuner.result;
+	uint16_t min, max;
+
+	read_link();
+
+	switch (step) {
+	case CONN_TUNER_PHY:
+		if (r->tx_phy == p->phy) {
+			*outcome = CONN_TUNER_OK;
+			return true;
+		}
+		*outcome = CONN_TUNER_FALLBACK;
+		return answered;
+	case CONN_TUNER_DLE:
+		if (r->tx_len >= p->tx_len) {
+			*outcome = CONN_TUNER_OK;
+			return true;
+		}
+		*outcome = CONN_TUNER_FALLBACK;
+		return answered;
+	case CONN_TUNER_MTU:
+		/* An ATT error is worth another try, like no answer. The MTU is
+		 * only exchanged once per connection, maybe by the central.
+		 */
+		*outcome = CONN_TUNER_OK;
+		return (answered && tuner.mtu_err == 0) || r->mtu > ATT_DEFAULT_MTU;
+	default:
+		if (r->interval >= p->interval_min && r->interval <= p->interval_max) {
+			*outcome = CONN_TUNER_OK;
+			return true;
+		}
+		interval_range(&min, &max);
+		*outcome = CONN_TUNER_FALLBACK;
+		return tuner.relaxed && r->interval >= min && r->interval <= max;
+	}
+}
+
+static void issue(enum conn_tuner_step step)
+{
+	atomic_clear_bit(&events, step);
+	tuner.result.attempts[step]++;
+	tuner.waiting = true;
+
+	int err = request(step);
+	if (err) {
+		/* Most likely another procedure still running, try again soon */
+		LOG_WRN("%s request failed (err %d)", step_names[step], err);
+		k_work_reschedule(&step_work, RETRY_DELAY);
+		return;
+	}
+	k_work_reschedule(&step_work, STEP_TIMEOUT);
+}
+
+static void finish(void)
+{
+	struct conn_tuner_result *r = &tuner.result;
+
+	read_link();
+	r->duration_ms = (uint32_t)(k_uptime_get() - tuner.start_ms);
+
+	LOG_INF("Tuned in %u ms: phy %s, dle %s, mtu %s, interval %s", r->duration_ms,
+		conn_tuner_outcome_str(r->outcome[CONN_TUNER_PHY]),
+		conn_tuner_outcome_str(r->outcome[CONN_TUNER_DLE]),
+		conn_tuner_outcome_str(r->outcome[CONN_TUNER_MTU]),
+		conn_tuner_outcome_str(r->outcome[CONN_TUNER_INTERVAL]));
+
+	if (tuner.done) {
+		tuner.done(tuner.conn, r);
+	}
+}
+
+static void step_work_handler(struct k_work *work)
+{
+	if (!tuner.conn) {
+		return;
+	}
+
+	if (tuner.waiting) {
+		enum conn_tuner_step step = tuner.step;
+		enum conn_tuner_outcome outcome;
+		bool answered = atomic_test_and_clear_bit(&events, step);
+
+		if (!evaluate(step, answered, &outcome)) {
+			if (answered && step != CONN_TUNER_MTU) {
+				/* Some other update, e.g. from the central; keep waiting */
+				k_work_reschedule(&step_work, STEP_TIMEOUT);
+				return;
+			}
+			if (tuner.result.attempts[step] <= CONFIG_APP_TUNER_RETRIES) {
+				issue(step);
+				return;
+			}
+			if (step == CONN_TUNER_INTERVAL && !tuner.relaxed) {
+				LOG_WRN("Interval rejected, asking for a wider range");
+				tuner.relaxed = true;
+				issue(step);
+				return;
+			}
+			outcome = CONN_TUNER_FAILED;
+		}
+
+		tuner.result.outcome[step] = outcome;
+		tuner.waiting = false;
+		tuner.step++;
+	}
+
+	for (; tuner.step < CONN_TUNER_STEPS; tuner.step++) {
+		if (!skipped(tuner.step)) {
+			issue(tuner.step);
+			return;
+		}
+		tuner.result.outcome[tuner.step] = CONN_TUNER_SKIPPED;
+	}
+
+	finish();
+	bt_conn_unref(tuner.conn);
+	tuner.conn = NULL;
+}
+
+static void on_event(struct bt_conn *conn, enum conn_tuner_step step)
+{
+	if (conn == tuner.conn && tuner.waiting && tuner.step == step) {
+		atomic_set_bit(&events, step);
+		k_work_reschedule(&step_work, K_NO_WAIT);
+	}
+}
+
+static void on_phy_updated(struct bt_conn *conn, struct bt_conn_le_phy_info *info)
+{
+	on_event(conn, CONN_TUNER_PHY);
+}
+
+static void on_data_len_updated(struct bt_conn *conn, struct bt_conn_le_data_len_info *info)
+{
+	on_event(conn, CONN_TUNER_DLE);
+}
+
+static void on_param_updated(struct bt_conn *conn, uint16_t interval, uint16_t latency,
+			     uint16_t timeout)
+{
+	on_event(conn, CONN_TUNER_INTERVAL);
+}
+
+static void on_disconnected(struct bt_conn *conn, uint8_t reason)
+{
+	if (conn == tuner.conn) {
+		struct k_work_sync sync;
+
+		/* A step already running on the system workqueue still uses
+		 * tuner.conn, wait for it before dropping the reference.
+		 */
+		k_work_cancel_delayable_sync(&step_work, &sync);
+		bt_conn_unref(tuner.conn);
+		tuner.conn = NULL;
+	}
+}
+
+BT_CONN_CB_DEFINE(tuner_callbacks) = {
+	.disconnected = on_disconnected,
+	.le_param_updated = on_param_updated,
+	.le_phy_updated = on_phy_updated,
+	.le_data_len_updated = on_data_len_updated,
+};
+
+void conn_tuner_init(conn_tuner_done_cb_t done)
+{
+	tuner.done = done;
+}
+
+int conn_tuner_start(struct bt_conn *conn, const struct conn_tuner_profile *profile)
+{
+	if (tuner.conn) {
+		return -EBUSY;
+	}
+
+	memset(&tuner.result, 0, sizeof(tuner.result));
+	tuner.result.profile = profile;
+	tuner.result.mtu = ATT_DEFAULT_MTU;
+	tuner.step = 0;
+	tuner.waiting = false;
+	tuner.relaxed = false;
+	tuner.start_ms = k_uptime_get();
+	atomic_clear(&events);
+
+	tuner.conn = bt_conn_ref(conn);
+	LOG_INF("Tuning for profile %s", profile->name);
+	k_work_reschedule(&step_work, K_NO_WAIT);
+	return 0;
+}
+
+const char *conn_tuner_outcome_str(enum conn_tuner_outcome outcome)
+{
+	static const char *const names[] = {"skipped", "ok", "fallback", "failed"};
+
+	return outcome < ARRAY_SIZE(names) ? names[outcome] : "?";
+}
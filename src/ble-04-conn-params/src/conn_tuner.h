@@ -0,0 +1,74 @@
+#ifndef CONN_TUNER_H_
+#define CONN_TUNER_H_
+
+#include <zephyr/bluetooth/conn.h>
+
+/* Connection tuner: negotiates PHY, data length, ATT MTU and connection
+ * interval one after the other, each step starting once the previous one
+ * is confirmed by its callback (le_phy_updated, le_data_len_updated, the
+ * MTU exchange callback, le_param_updated) instead of firing all requests
+ * at once and hoping for the best.
+ *
+ * A step that gets no answer within CONFIG_APP_TUNER_STEP_TIMEOUT_MS, or
+ * whose request fails, is retried up to CONFIG_APP_TUNER_RETRIES times. A
+ * peer that answers with less than asked for (1M instead of 2M, a shorter
+ * data length) is taken at its word. A rejected interval is asked for
+ * again with a wider range before the tuner gives up on it. In every case
+ * the link keeps working with what it has, and the next step runs.
+ *
+ * All steps run on the system workqueue. One connection at a time.
+ */
+
+enum conn_tuner_step {
+	CONN_TUNER_PHY,
+	CONN_TUNER_DLE,
+	CONN_TUNER_MTU,
+	CONN_TUNER_INTERVAL,
+	CONN_TUNER_STEPS,
+};
+
+enum conn_tuner_outcome {
+	CONN_TUNER_SKIPPED,  /* not part of the profile */
+	CONN_TUNER_OK,       /* got what was asked for */
+	CONN_TUNER_FALLBACK, /* the peer settled on less, or the wider interval range */
+	CONN_TUNER_FAILED,   /* no answer after the retries, the link is unchanged */
+};
+
+/* What to ask for. A zero field skips its step. */
+struct conn_tuner_profile {
+	const char *name;
+	uint8_t phy;           /* BT_GAP_LE_PHY_1M or BT_GAP_LE_PHY_2M */
+	uint16_t tx_len;       /* link layer payload, 27 to 251 bytes */
+	bool mtu;              /* exchange the ATT MTU (CONFIG_BT_L2CAP_TX_MTU) */
+	uint16_t interval_min; /* units of 1.25 ms */
+	uint16_t interval_max;
+};
+
+struct conn_tuner_result {
+	const struct conn_tuner_profile *profile;
+	enum conn_tuner_outcome outcome[CONN_TUNER_STEPS];
+	uint8_t attempts[CONN_TUNER_STEPS];
+	uint8_t tx_phy;
+	uint8_t rx_phy;
+	uint16_t tx_len;
+	uint16_t rx_len;
+	uint16_t mtu;
+	uint16_t interval; /* units of 1.25 ms */
+	uint16_t latency;
+	uint16_t timeout;  /* units of 10 ms */
+	uint32_t duration_ms;
+};
+
+/* Called on the system workqueue once every step is done */
+typedef void (*conn_tuner_done_cb_t)(struct bt_conn *conn, const struct conn_tuner_result *result);
+
+void conn_tuner_init(conn_tuner_done_cb_t done);
+
+/* Starts tuning a new connection, -EBUSY if another one is being tuned.
+ * 'profile' must stay valid until done. Stops by itself on disconnect.
+ */
+int conn_tuner_start(struct bt_conn *conn, const struct conn_tuner_profile *profile);
+
+const char *conn_tuner_outcome_str(enum conn_tuner_outcome outcome);
+
+#endif /* CONN_TUNER_H_ */
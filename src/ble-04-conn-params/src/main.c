@@ -4,6 +4,12 @@
 #include <zephyr/bluetooth/gap.h>
 #include <zephyr/bluetooth/gatt.h>
 #include <zephyr/bluetooth/conn.h>
+#include <string.h>
+
+#include "cb_timing.h"
+#include "conn_param_mgr.h"
+#include "conn_tuner.h"
+#include "tput_service.h"
 
 LOG_MODULE_REGISTER(conn_params, LOG_LEVEL_INF);
 
@@ -17,32 +23,51 @@ static const struct bt_data adv_payload[] = {
 
 static struct bt_conn *active_conn = NULL;
 
+/* What the tuner asks for, one step more per profile, from the defaults of
+ * a new connection (1M PHY, 27 byte PDUs, 23 byte ATT MTU) to everything.
+ * CONFIG_APP_TUNER_PROFILE picks one; with CONFIG_APP_TUNER_CYCLE every new
+ * connection takes the next, to compare their goodput.
+ */
+#define TUNER_INTERVAL CONFIG_APP_TUNER_INTERVAL_MIN, CONFIG_APP_TUNER_INTERVAL_MAX
+
+static const struct conn_tuner_profile tuner_profiles[] = {
+	{"1M/27/23", BT_GAP_LE_PHY_1M, 0, false, TUNER_INTERVAL},
+	{"2M/27/23", BT_GAP_LE_PHY_2M, 0, false, TUNER_INTERVAL},
+	{"2M/251/23", BT_GAP_LE_PHY_2M, BT_GAP_DATA_LEN_MAX, false, TUNER_INTERVAL},
+	{"2M/251/247", BT_GAP_LE_PHY_2M, BT_GAP_DATA_LEN_MAX, true, TUNER_INTERVAL},
+};
+
+BUILD_ASSERT(CONFIG_APP_TUNER_PROFILE < ARRAY_SIZE(tuner_profiles), "No such tuner profile");
+
+static int profile_index = CONFIG_APP_TUNER_PROFILE;
+static struct conn_tuner_result tuned;
+
+/* Interval in effect, from le_param_updated. The parameter manager can move
+ * it away from what the tuner left.
+ */
+static uint16_t link_interval;
+
+/* Interval in units of 1.25 ms, as ms with two decimals without floating point */
+#define INTERVAL_CENTI_MS(interval) ((uint32_t)(interval) * 125)
+
 /* Connection Parameter Update Callback */
 static void handle_conn_param_change(struct bt_conn *conn, uint16_t interval, uint16_t latency, uint16_t timeout)
 {
-	double interval_ms = interval * 1.25;
+	uint32_t t = cb_timing_start();
+	uint32_t interval_cms = INTERVAL_CENTI_MS(interval);
 	uint16_t timeout_ms = timeout * 10;
-	LOG_INF("Params changed: %.2f ms, latency %u, timeout %u ms", interval_ms, latency, timeout_ms);
-}
 
-/* PHY Request */
-static void request_phy_update(struct bt_conn *conn)
-{
-	const struct bt_conn_le_phy_param phy_pref = {
-		.options = BT_CONN_LE_PHY_OPT_NONE,
-		.pref_rx_phy = BT_GAP_LE_PHY_2M,
-		.pref_tx_phy = BT_GAP_LE_PHY_2M,
-	};
-
-	int err = bt_conn_le_phy_update(conn, &phy_pref);
-	if (err) {
-		LOG_ERR("PHY update failed (%d)", err);
-	}
+	link_interval = interval;
+	LOG_INF("Params changed: %u.%02u ms, latency %u, timeout %u ms", interval_cms / 100,
+		interval_cms % 100, latency, timeout_ms);
+	cb_timing_end("le_param_updated", t);
 }
 
 /* PHY Change Notification */
 static void handle_phy_change(struct bt_conn *conn, struct bt_conn_le_phy_info *info)
 {
+	uint32_t t = cb_timing_start();
+
 	switch (info->tx_phy) {
 	case BT_CONN_LE_TX_POWER_PHY_1M:
 		LOG_INF("PHY switched to 1M");
@@ -57,59 +82,28 @@ static void handle_phy_change(struct bt_conn *conn, struct bt_conn_le_phy_info *
 		LOG_INF("PHY changed to unknown mode");
 		break;
 	}
-}
-
-/* Data Length Request */
-static void request_data_len_update(struct bt_conn *conn)
-{
-	struct bt_conn_le_data_len_param len_params = {
-		.tx_max_len = BT_GAP_DATA_LEN_MAX,
-		.tx_max_time = BT_GAP_DATA_TIME_MAX,
-	};
 
-	int err = bt_conn_le_data_len_update(conn, &len_params);
-	if (err) {
-		LOG_ERR("Failed to update data length (%d)", err);
-	}
+	cb_timing_end("le_phy_updated", t);
 }
 
 /* Data Length Change Notification */
 static void handle_data_len_change(struct bt_conn *conn, struct bt_conn_le_data_len_info *info)
 {
+	uint32_t t = cb_timing_start();
 	LOG_INF("Data len: TX=%u (%uus), RX=%u (%uus)",
 		info->tx_max_len, info->tx_max_time,
 		info->rx_max_len, info->rx_max_time);
-}
-
-/* MTU Exchange Callback */
-static void mtu_exchange_cb(struct bt_conn *conn, uint8_t err, struct bt_gatt_exchange_params *params)
-{
-	if (!err) {
-		uint16_t app_mtu = bt_gatt_get_mtu(conn) - 3;
-		LOG_INF("MTU negotiated: %u bytes", app_mtu);
-	} else {
-		LOG_ERR("MTU exchange failed (ATT err %u)", err);
-	}
-}
-
-/* MTU Exchange Trigger */
-static void trigger_mtu_exchange(struct bt_conn *conn)
-{
-	static struct bt_gatt_exchange_params params = {
-		.func = mtu_exchange_cb
-	};
-
-	int err = bt_gatt_exchange_mtu(conn, &params);
-	if (err) {
-		LOG_ERR("MTU exchange failed (%d)", err);
-	}
+	cb_timing_end("le_data_len_updated", t);
 }
 
 /* Connection Event */
 static void on_conn_established(struct bt_conn *conn, uint8_t err)
 {
+	uint32_t t = cb_timing_start();
+
 	if (err) {
 		LOG_ERR("Failed to connect (err %u)", err);
+		cb_timing_end("connected", t);
 		return;
 	}
 
@@ -118,25 +112,87 @@ static void on_conn_established(struct bt_conn *conn, uint8_t err)
 
 	struct bt_conn_info info;
 	if (bt_conn_get_info(conn, &info) == 0) {
-		double int_ms = info.le.interval * 1.25;
+		uint32_t int_cms = INTERVAL_CENTI_MS(info.le.interval);
 		uint16_t timeout_ms = info.le.timeout * 10;
-		LOG_INF("Initial conn params: %.2f ms, latency %u, timeout %u ms", int_ms, info.le.latency, timeout_ms);
+
+		link_interval = info.le.interval;
+		LOG_INF("Initial conn params: %u.%02u ms, latency %u, timeout %u ms", int_cms / 100,
+			int_cms % 100, info.le.latency, timeout_ms);
 	}
 
-	request_phy_update(conn);
-	request_data_len_update(conn);
-	trigger_mtu_exchange(conn);
+	/* PHY, data length, MTU and interval, one after the other */
+	memset(&tuned, 0, sizeof(tuned));
+	int ret = conn_tuner_start(conn, &tuner_profiles[profile_index]);
+	if (ret) {
+		LOG_ERR("Tuner start failed (%d)", ret);
+	}
+	if (IS_ENABLED(CONFIG_APP_TUNER_CYCLE)) {
+		profile_index = (profile_index + 1) % ARRAY_SIZE(tuner_profiles);
+	}
+
+	cb_timing_end("connected", t);
 }
 
 /* Disconnection Event */
 static void on_conn_terminated(struct bt_conn *conn, uint8_t reason)
 {
+	uint32_t t = cb_timing_start();
+
 	LOG_INF("Disconnected (reason: 0x%02x)", reason);
 
 	if (active_conn) {
 		bt_conn_unref(active_conn);
 		active_conn = NULL;
 	}
+
+	cb_timing_end("disconnected", t);
+	cb_timing_print(); /* see ../common/cb_timing.conf */
+}
+
+static void start_advertising(void)
+{
+	int err = bt_le_adv_start(BT_LE_ADV_CONN_ONE_TIME, adv_payload,
+				  ARRAY_SIZE(adv_payload), NULL, 0);
+	if (err) {
+		LOG_ERR("Adv start failed (%d)", err);
+		return;
+	}
+
+	LOG_INF("Advertising (connectable) started");
+}
+
+/* Connection object free again, advertise for the next central */
+static void on_conn_recycled(void)
+{
+	start_advertising();
+}
+
+/* Tuning done, measure what it got. From here on the interval follows the
+ * load (../common/conn_param_mgr.h).
+ */
+static void on_tuned(struct bt_conn *conn, const struct conn_tuner_result *result)
+{
+	tuned = *result;
+	conn_param_mgr_start(conn);
+	tput_arm(conn, CONFIG_APP_TPUT_DURATION_MS);
+}
+
+/* One line per tuned configuration. run_interval_us is the interval in
+ * effect when the run ended, the same as interval_us unless the parameter
+ * manager or the central changed it.
+ */
+static void on_tput_done(struct bt_conn *conn, const struct tput_result *result)
+{
+	printk("{\"profile\":\"%s\",\"tx_phy\":%u,\"tx_len\":%u,\"rx_len\":%u,\"mtu\":%u,"
+	       "\"interval_us\":%u,\"run_interval_us\":%u,\"phy\":\"%s\",\"dle\":\"%s\","
+	       "\"mtu_step\":\"%s\",\"interval\":\"%s\",\"tune_ms\":%u,\"bytes\":%u,\"ms\":%u,\"kbps\":%u}\n",
+	       tuned.profile ? tuned.profile->name : "untuned", tuned.tx_phy, tuned.tx_len,
+	       tuned.rx_len, tuned.mtu, tuned.interval * 1250U, link_interval * 1250U,
+	       conn_tuner_outcome_str(tuned.outcome[CONN_TUNER_PHY]),
+	       conn_tuner_outcome_str(tuned.outcome[CONN_TUNER_DLE]),
+	       conn_tuner_outcome_str(tuned.outcome[CONN_TUNER_MTU]),
+	       conn_tuner_outcome_str(tuned.outcome[CONN_TUNER_INTERVAL]), tuned.duration_ms,
+	       result->bytes, result->ms, result->kbps);
 }
 
 /* Register callbacks */
@@ -146,6 +202,7 @@ static struct bt_conn_cb conn_callbacks = {
 	.le_param_updated = handle_conn_param_change,
 	.le_phy_updated = handle_phy_change,
 	.le_data_len_updated = handle_data_len_change,
+	.recycled = on_conn_recycled,
 };
 
 void main(void)
@@ -160,14 +217,9 @@ void main(void)
 		return;
 	}
 
-	int err = bt_le_adv_start(BT_LE_ADV_CONN_ONE_TIME, adv_payload,
-				  ARRAY_SIZE(adv_payload), NULL, 0);
-	if (err) {
-		LOG_ERR("Adv start failed (%d)", err);
-		return;
-	}
-
-	LOG_INF("Advertising (connectable) started");
+	conn_tuner_init(on_tuned);
+	tput_init(on_tput_done);
+	start_advertising();
 
 	while (1) {
 		k_sleep(K_SECONDS(1));
@@ -0,0 +1,255 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/gatt.h>
+
+#include "conn_param_mgr.h"
+#include "tput_service.h"
+
+LOG_MODULE_REGISTER(tput_service, LOG_LEVEL_INF);
+
+#define PAYLOAD_MAX (CONFIG_BT_L2CAP_TX_MTU - 3)
+#define RESULT_LEN 12
+#define DRAIN_MS 1000
+#define THREAD_STACK_SIZE 1024
+#define THREAD_PRIORITY 7
+
+static struct k_spinlock lock;
+static struct bt_conn *armed_conn; /* under 'lock' */
+static uint32_t duration_ms = CONFIG_APP_TPUT_DURATION_MS;
+static tput_done_cb_t done_cb;
+
+static bool data_notify;
+static bool result_notify;
+static struct tput_result last;
+static uint8_t payload[PAYLOAD_MAX];
+
+/* Updated by the stack as notifications go out */
+static atomic_t sent_bytes;
+static atomic_t pending;
+static int64_t last_sent_ms;
+
+static K_SEM_DEFINE(start_sem, 0, 1);
+
+static void encode_result(const struct tput_result *result, uint8_t *buf)
+{
+	sys_put_le32(result->bytes, &buf[0]);
+	sys_put_le32(result->ms, &buf[4]);
+	sys_put_le32(result->kbps, &buf[8]);
+}
+
+static void data_ccc_changed(const struct bt_gatt_attr *attr, uint16_t value)
+{
+	data_notify = value == BT_GATT_CCC_NOTIFY;
+	if (data_notify) {
+		k_sem_give(&start_sem);
+	}
+}
+
+static void result_ccc_changed(const struct bt_gatt_attr *attr, uint16_t value)
+{
+	result_notify = value == BT_GATT_CCC_NOTIFY;
+}
+
+static ssize_t read_result(struct bt_conn *conn, const struct bt_gatt_attr *attr, void *buf,
+			   uint16_t len, uint16_t offset)
+{
+	uint8_t value[RESULT_LEN];
+
+	encode_result(&last, value);
+	return bt_gatt_attr_read(conn, attr, buf, len, offset, value, sizeof(value));
+}
+
+static ssize_t write_result(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+			    const void *buf, uint16_t len, uint16_t offset, uint8_t flags)
+{
+	if (offset != 0) {
+		return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+	}
+	if (len != sizeof(uint32_t)) {
+		return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+	}
+
+	conn_param_mgr_rx(conn, len);
+
+	uint32_t ms = sys_get_le32(buf);
+	if (ms == 0) {
+		return BT_GATT_ERR(BT_ATT_ERR_VALUE_NOT_ALLOWED);
+	}
+
+	tput_arm(conn, ms);
+	return len;
+}
+
+BT_GATT_SERVICE_DEFINE(tput_svc,
+	BT_GATT_PRIMARY_SERVICE(BT_UUID_TPUT_SERVICE),
+
+	/* Test data (notify) */
+	BT_GATT_CHARACTERISTIC(BT_UUID_TPUT_DATA, BT_GATT_CHRC_NOTIFY,
+			       BT_GATT_PERM_NONE, NULL, NULL, NULL),
+	BT_GATT_CCC(data_ccc_changed, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),
+
+	/* Result of the last test (read, notify), write to start one */
+	BT_GATT_CHARACTERISTIC(BT_UUID_TPUT_RESULT,
+			       BT_GATT_CHRC_READ | BT_GATT_CHRC_WRITE | BT_GATT_CHRC_NOTIFY,
+			       BT_GATT_PERM_READ | BT_GATT_PERM_WRITE, read_result, write_result,
+			       NULL),
+	BT_GATT_CCC(result_ccc_changed, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE));
+
+#define DATA_ATTR (&tput_svc.attrs[2])
+#define RESULT_ATTR (&tput_svc.attrs[5])
+
+static void sent_cb(struct bt_conn *conn, void *user_data)
+{
+	atomic_add(&sent_bytes, (atomic_val_t)POINTER_TO_UINT(user_data));
+	conn_param_mgr_tx_done(conn, POINTER_TO_UINT(user_data));
+	atomic_dec(&pending);
+	last_sent_ms = k_uptime_get();
+}
+
+static void run_test(struct bt_conn *conn, uint32_t ms)
+{
+	uint16_t len = MIN(bt_gatt_get_mtu(conn) - 3U, sizeof(payload));
+	struct tput_result result;
+	int err = 0;
+
+	atomic_clear(&sent_bytes);
+	atomic_clear(&pending);
+
+	int64_t start_ms = k_uptime_get();
+	last_sent_ms = start_ms;
+
+	while (data_notify && k_uptime_get() - start_ms < ms) {
+		struct bt_gatt_notify_params params = {
+			.attr = DATA_ATTR,
+			.data = payload,
+			.len = len,
+			.func = sent_cb,
+			.user_data = UINT_TO_POINTER(len),
+		};
+
+		atomic_inc(&pending);
+		err = bt_gatt_notify_cb(conn, &params);
+		if (err) {
+			atomic_dec(&pending);
+			if (err != -ENOMEM) {
+				break;
+			}
+			/* All TX buffers in flight */
+			k_sleep(K_MSEC(1));
+			err = 0;
+		} else {
+			conn_param_mgr_tx_queued(conn, len);
+		}
+	}
+
+	/* What is queued still counts, once it is sent */
+	for (int i = 0; i < DRAIN_MS && atomic_get(&pending) > 0; i++) {
+		k_sleep(K_MSEC(1));
+	}
+
+	result.bytes = (uint32_t)atomic_get(&sent_bytes);
+	result.ms = MAX((uint32_t)(last_sent_ms - start_ms), 1);
+	result.kbps = (uint32_t)((uint64_t)result.bytes * 8 / result.ms);
+	last = result;
+
+	if (err) {
+		LOG_WRN("Test stopped early (err %d)", err);
+	}
+	LOG_INF("Goodput: %u bytes in %u ms, %u kbps (%u byte notifications)", result.bytes,
+		result.ms, result.kbps, len);
+
+	if (result_notify) {
+		uint8_t value[RESULT_LEN];
+
+		encode_result(&result, value);
+		bt_gatt_notify(conn, RESULT_ATTR, value, sizeof(value));
+	}
+
+	if (done_cb) {
+		done_cb(conn, &result);
+	}
+}
+
+static void tput_thread(void *p1, void *p2, void *p3)
+{
+	for (;;) {
+		k_sem_take(&start_sem, K_FOREVER);
+
+		k_spinlock_key_t key = k_spin_lock(&lock);
+		struct bt_conn *conn = armed_conn;
+		armed_conn = NULL;
+		k_spin_unlock(&lock, key);
+
+		if (!conn) {
+			continue;
+		}
+		if (!data_notify) {
+			/* Not yet, data_ccc_changed() tries again */
+			key = k_spin_lock(&lock);
+			if (!armed_conn) {
+				armed_conn = conn;
+				conn = NULL;
+			}
+			k_spin_unlock(&lock, key);
+			if (conn) {
+				bt_conn_unref(conn);
+			}
+			continue;
+		}
+
+		run_test(conn, duration_ms);
+		bt_conn_unref(conn);
+	}
+}
+
+K_THREAD_DEFINE(tput_thread_id, THREAD_STACK_SIZE, tput_thread, NULL, NULL, NULL,
+		THREAD_PRIORITY, 0, 0);
+
+static void on_disconnected(struct bt_conn *conn, uint8_t reason)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+	struct bt_conn *armed = armed_conn == conn ? armed_conn : NULL;
+
+	if (armed) {
+		armed_conn = NULL;
+	}
+	k_spin_unlock(&lock, key);
+
+	if (armed) {
+		bt_conn_unref(armed);
+	}
+	data_notify = false;
+	result_notify = false;
+}
+
+BT_CONN_CB_DEFINE(tput_conn_callbacks) = {
+	.disconnected = on_disconnected,
+};
+
+void tput_init(tput_done_cb_t done)
+{
+	done_cb = done;
+	for (size_t i = 0; i < sizeof(payload); i++) {
+		payload[i] = (uint8_t)i;
+	}
+}
+
+void tput_arm(struct bt_conn *conn, uint32_t ms)
+{
+	struct bt_conn *old;
+
+	k_spinlock_key_t key = k_spin_lock(&lock);
+	old = armed_conn;
+	armed_conn = bt_conn_ref(conn);
+	duration_ms = ms;
+	k_spin_unlock(&lock, key);
+
+	if (old) {
+		bt_conn_unref(old);
+	}
+	k_sem_give(&start_sem);
+}
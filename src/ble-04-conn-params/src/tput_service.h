@@ -0,0 +1,46 @@
+#ifndef TPUT_SERVICE_H_
+#define TPUT_SERVICE_H_
+
+#include <zephyr/types.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/uuid.h>
+
+/* Throughput test service. Once armed for a connection, a test starts as
+ * soon as the client has enabled notifications of the Data
+ * characteristic: it is sent notifications of ATT MTU - 3 bytes, as fast
+ * as the stack takes them, for CONFIG_APP_TPUT_DURATION_MS. Goodput is
+ * payload bytes the controller got onto the air over the time from the
+ * first notification to the last one sent, so ATT, L2CAP and link layer
+ * overhead and any retransmissions count against it.
+ *
+ * The result (three little-endian uint32: bytes, ms, kbps) can be read
+ * from the Result characteristic, and is notified on it if enabled.
+ * Writing a duration in ms (uint32, little-endian) to Result starts
+ * another test.
+ */
+
+#define BT_UUID_TPUT_SERVICE_VAL BT_UUID_128_ENCODE(0x7a3f0000, 0x5e7b, 0x4a61, 0x9d2c, 0x04c0ffee0004)
+#define BT_UUID_TPUT_DATA_VAL BT_UUID_128_ENCODE(0x7a3f0001, 0x5e7b, 0x4a61, 0x9d2c, 0x04c0ffee0004)
+#define BT_UUID_TPUT_RESULT_VAL BT_UUID_128_ENCODE(0x7a3f0002, 0x5e7b, 0x4a61, 0x9d2c, 0x04c0ffee0004)
+
+#define BT_UUID_TPUT_SERVICE BT_UUID_DECLARE_128(BT_UUID_TPUT_SERVICE_VAL)
+#define BT_UUID_TPUT_DATA BT_UUID_DECLARE_128(BT_UUID_TPUT_DATA_VAL)
+#define BT_UUID_TPUT_RESULT BT_UUID_DECLARE_128(BT_UUID_TPUT_RESULT_VAL)
+
+struct tput_result {
+	uint32_t bytes;
+	uint32_t ms;
+	uint32_t kbps; /* payload kilobits per second */
+};
+
+/* Called from the test thread when a test is over */
+typedef void (*tput_done_cb_t)(struct bt_conn *conn, const struct tput_result *result);
+
+void tput_init(tput_done_cb_t done);
+
+/* Runs a test on 'conn' once notifications are enabled, right away if they
+ * already are. Disarmed on disconnect.
+ */
+void tput_arm(struct bt_conn *conn, uint32_t duration_ms);
+
+#endif /* TPUT_SERVICE_H_ */
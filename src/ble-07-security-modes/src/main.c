@@ -4,6 +4,7 @@
 #include <zephyr/bluetooth/bluetooth.h>
 #include <zephyr/bluetooth/conn.h>
 #include <zephyr/bluetooth/gap.h>
+#include "conn_param_mgr.h"
 #include "my_service.h"
 
 LOG_MODULE_REGISTER(main, LOG_LEVEL_INF);
@@ -29,6 +30,9 @@ static void on_connected(struct bt_conn *conn, uint8_t err)
 	}
 
 	LOG_INF("Connected\n");
+
+	/* Long interval with latency while idle, short one for traffic */
+	conn_param_mgr_start(conn);
 }
 
 static void on_disconnected(struct bt_conn *conn, uint8_t reason)
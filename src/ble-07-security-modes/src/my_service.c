@@ -3,6 +3,7 @@
 #include <zephyr/logging/log.h>
 #include <string.h>
 
+#include "conn_param_mgr.h"
 #include "my_service.h"
 
 LOG_MODULE_REGISTER(my_service, LOG_LEVEL_INF);
@@ -15,6 +16,8 @@ static ssize_t encrypt_write(struct bt_conn *conn, const struct bt_gatt_attr *at
         return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
     }
 
+    conn_param_mgr_rx(conn, len);
+
     uint8_t value = *(uint8_t *)buf;
     LOG_INF("Encrypted write: %u", value);
 
@@ -29,6 +32,8 @@ static ssize_t authen_write(struct bt_conn *conn, const struct bt_gatt_attr *att
         return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
     }
 
+    conn_param_mgr_rx(conn, len);
+
     uint8_t value = *(uint8_t *)buf;
     LOG_INF("Authenticated write: %u", value);
 
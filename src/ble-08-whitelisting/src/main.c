@@ -7,6 +7,7 @@
 #include <zephyr/bluetooth/gap.h>
 #include <zephyr/settings/settings.h>
 #include "my_service.h"
+#include "wq_pool.h"
 
 LOG_MODULE_REGISTER(main, LOG_LEVEL_INF);
 
@@ -31,11 +32,13 @@ static const struct bt_data sd[] = {
 	BT_LE_ADV_PARAM(BT_LE_ADV_OPT_CONN | BT_LE_ADV_OPT_FILTER_CONN | BT_LE_ADV_OPT_FILTER_SCAN_REQ, \
 					BT_GAP_ADV_FAST_INT_MIN_2, BT_GAP_ADV_FAST_INT_MAX_2, NULL)
 
-static struct k_work adv_work;
+// Advertising restarts run on the pool's latency queue, so they are not
+// delayed by whatever else is queued on the system workqueue
+static struct wq_pool_work adv_work;
 static void start_advertising(void)
 {
 	LOG_INF("Starting advertising\n");
-	k_work_submit(&adv_work);
+	wq_pool_submit(&adv_work);
 }
 
 // ##################### Connection Callbacks ########################
@@ -248,7 +251,8 @@ static void advertisement_handler(struct k_work *work_item)
 
 int main(void)
 {
-	k_work_init(&adv_work, advertisement_handler);
+	wq_pool_init();
+	wq_pool_work_init(&adv_work, advertisement_handler, WQ_CLASS_LATENCY);
 
 	int err;
 
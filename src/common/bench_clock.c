@@ -0,0 +1,22 @@
+#include <zephyr/kernel.h>
+
+#include "bench_clock.h"
+
+#ifdef CONFIG_ARCH_POSIX
+
+// bench_clock_bottom.c, runs against the host C library
+uint64_t bench_clock_host_ns(void);
+
+uint64_t bench_clock_ns(void)
+{
+    return bench_clock_host_ns();
+}
+
+#else
+
+uint64_t bench_clock_ns(void)
+{
+    return k_ticks_to_ns_floor64(k_uptime_ticks());
+}
+
+#endif
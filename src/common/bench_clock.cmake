@@ -0,0 +1,10 @@
+# Shared benchmark clock (bench_clock.c). Include from a sample's
+# CMakeLists.txt after find_package(Zephyr):
+#   include(${CMAKE_CURRENT_SOURCE_DIR}/../common/bench_clock.cmake)
+target_sources(app PRIVATE ${CMAKE_CURRENT_LIST_DIR}/bench_clock.c)
+target_include_directories(app PRIVATE ${CMAKE_CURRENT_LIST_DIR})
+
+if(CONFIG_ARCH_POSIX)
+  # Host half, linked into the native simulator runner
+  target_sources(native_simulator INTERFACE ${CMAKE_CURRENT_LIST_DIR}/bench_clock_bottom.c)
+endif()
@@ -0,0 +1,15 @@
+#ifndef BENCH_CLOCK_H_
+#define BENCH_CLOCK_H_
+
+#include <stdint.h>
+
+// Elapsed wall-clock time for CPU-bound benchmarks. On hardware this is the
+// kernel's uptime. On the POSIX arch (native_sim, the bsim boards) Zephyr
+// code runs in zero simulated time, so k_uptime_get() and k_cycle_get_32()
+// stand still in a busy loop; there the host's CLOCK_MONOTONIC is read
+// through bench_clock_bottom.c, which is built into the native simulator
+// runner. Include ../common/bench_clock.cmake from the app.
+
+uint64_t bench_clock_ns(void);
+
+#endif /* BENCH_CLOCK_H_ */
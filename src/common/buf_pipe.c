@@ -0,0 +1,88 @@
+#include <zephyr/kernel.h>
+#include <string.h>
+
+#include "buf_pipe.h"
+
+void buf_pipe_init(struct buf_pipe *pipe)
+{
+    k_fifo_init(&pipe->fifo);
+    memset(&pipe->stats, 0, sizeof(pipe->stats));
+}
+
+struct buf_pipe_buf *buf_pipe_alloc(struct buf_pipe *pipe, k_timeout_t timeout)
+{
+    void *block;
+
+    if (k_mem_slab_alloc(pipe->slab, &block, K_NO_WAIT) != 0)
+    {
+        k_spinlock_key_t key = k_spin_lock(&pipe->lock);
+        pipe->stats.alloc_waits++;
+        k_spin_unlock(&pipe->lock, key);
+
+        if (k_mem_slab_alloc(pipe->slab, &block, timeout) != 0)
+            return NULL;
+    }
+
+    struct buf_pipe_buf *buf = block;
+    buf->len = 0;
+    return buf;
+}
+
+void buf_pipe_put(struct buf_pipe *pipe, struct buf_pipe_buf *buf)
+{
+    k_fifo_put(&pipe->fifo, buf);
+}
+
+int buf_pipe_get_batch(struct buf_pipe *pipe, struct buf_pipe_buf **bufs, int max,
+                       k_timeout_t timeout)
+{
+    bool blocked = k_fifo_is_empty(&pipe->fifo);
+
+    if (blocked)
+    {
+        struct k_poll_event event = K_POLL_EVENT_INITIALIZER(
+            K_POLL_TYPE_FIFO_DATA_AVAILABLE, K_POLL_MODE_NOTIFY_ONLY, &pipe->fifo);
+
+        if (k_poll(&event, 1, timeout) != 0)
+            return 0;
+    }
+
+    // Everything queued while we slept comes out in this one wakeup
+    int count = 0;
+    while (count < max)
+    {
+        struct buf_pipe_buf *buf = k_fifo_get(&pipe->fifo, K_NO_WAIT);
+        if (!buf)
+            break;
+        bufs[count++] = buf;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&pipe->lock);
+    pipe->stats.buffers += count;
+    if (blocked && count > 0)
+        pipe->stats.wakeups++;
+    if ((uint32_t)count > pipe->stats.max_batch)
+        pipe->stats.max_batch = count;
+    k_spin_unlock(&pipe->lock, key);
+
+    return count;
+}
+
+void buf_pipe_free(struct buf_pipe *pipe, struct buf_pipe_buf *buf)
+{
+    k_mem_slab_free(pipe->slab, buf);
+}
+
+void buf_pipe_stats_get(struct buf_pipe *pipe, struct buf_pipe_stats *stats)
+{
+    k_spinlock_key_t key = k_spin_lock(&pipe->lock);
+    *stats = pipe->stats;
+    k_spin_unlock(&pipe->lock, key);
+}
+
+void buf_pipe_stats_reset(struct buf_pipe *pipe)
+{
+    k_spinlock_key_t key = k_spin_lock(&pipe->lock);
+    memset(&pipe->stats, 0, sizeof(pipe->stats));
+    k_spin_unlock(&pipe->lock, key);
+}
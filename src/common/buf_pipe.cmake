@@ -0,0 +1,5 @@
+# Shared zero-copy buffer pipe (buf_pipe.c). Include from a sample's CMakeLists.txt
+# after find_package(Zephyr):
+#   include(${CMAKE_CURRENT_SOURCE_DIR}/../common/buf_pipe.cmake)
+target_sources(app PRIVATE ${CMAKE_CURRENT_LIST_DIR}/buf_pipe.c)
+target_include_directories(app PRIVATE ${CMAKE_CURRENT_LIST_DIR})
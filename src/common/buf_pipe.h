@@ -0,0 +1,63 @@
+#ifndef BUF_PIPE_H_
+#define BUF_PIPE_H_
+
+#include <zephyr/kernel.h>
+
+// Zero-copy producer/consumer pipe: producers take a fixed-size buffer from a
+// k_mem_slab, fill it in place and pass it on through a k_fifo. Consumers
+// wait with k_poll(), drain every buffer queued by then in one go and give
+// them back to the slab. Only pointers move, never the data.
+//
+// Needs CONFIG_POLL=y. Include ../common/buf_pipe.cmake from the app.
+
+struct buf_pipe_buf
+{
+    void *fifo_reserved; // first word belongs to the k_fifo
+    uint16_t len;
+    uint8_t data[];
+};
+
+// Slab block size for buffers with 'size' bytes of data
+#define BUF_PIPE_BLOCK_SIZE(size) WB_UP(sizeof(struct buf_pipe_buf) + (size))
+
+// Defines a slab with 'count' buffers of 'size' bytes, and a pipe using it
+#define BUF_PIPE_DEFINE(_name, _size, _count)                                          \
+    K_MEM_SLAB_DEFINE_STATIC(_name##_slab, BUF_PIPE_BLOCK_SIZE(_size), _count,         \
+                             sizeof(void *));                                          \
+    static struct buf_pipe _name = {.slab = &_name##_slab, .size = (_size)}
+
+struct buf_pipe_stats
+{
+    uint32_t buffers;     // handed to consumers
+    uint32_t wakeups;     // times a consumer had to block before getting buffers
+    uint32_t max_batch;   // most buffers returned by one buf_pipe_get_batch()
+    uint32_t alloc_waits; // times a producer found the slab empty
+};
+
+struct buf_pipe
+{
+    struct k_mem_slab *slab;
+    uint16_t size; // data bytes per buffer
+
+    // Private
+    struct k_fifo fifo;
+    struct k_spinlock lock;
+    struct buf_pipe_stats stats;
+};
+
+void buf_pipe_init(struct buf_pipe *pipe);
+
+// Producer side. Returns NULL on timeout.
+struct buf_pipe_buf *buf_pipe_alloc(struct buf_pipe *pipe, k_timeout_t timeout);
+void buf_pipe_put(struct buf_pipe *pipe, struct buf_pipe_buf *buf);
+
+// Consumer side. Waits up to 'timeout' for the first buffer, then takes up to
+// 'max' without waiting. Returns the number of buffers stored in 'bufs'.
+int buf_pipe_get_batch(struct buf_pipe *pipe, struct buf_pipe_buf **bufs, int max,
+                       k_timeout_t timeout);
+void buf_pipe_free(struct buf_pipe *pipe, struct buf_pipe_buf *buf);
+
+void buf_pipe_stats_get(struct buf_pipe *pipe, struct buf_pipe_stats *stats);
+void buf_pipe_stats_reset(struct buf_pipe *pipe);
+
+#endif /* BUF_PIPE_H_ */
@@ -0,0 +1,79 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <string.h>
+
+#include "cb_timing.h"
+
+#if defined(CONFIG_LOG_MODE_IMMEDIATE)
+#define LOG_MODE "immediate"
+#elif defined(CONFIG_LOG_MODE_DEFERRED)
+#define LOG_MODE "deferred"
+#elif defined(CONFIG_LOG_MODE_MINIMAL)
+#define LOG_MODE "minimal"
+#else
+#define LOG_MODE "off"
+#endif
+
+#if defined(CONFIG_APP_CB_TIMING)
+
+static struct cb_timing_entry table[CB_TIMING_MAX_CALLBACKS];
+static struct k_spinlock lock;
+
+void cb_timing_end(const char *name, uint32_t start)
+{
+    uint32_t cycles = k_cycle_get_32() - start;
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    for (int i = 0; i < CB_TIMING_MAX_CALLBACKS; i++)
+    {
+        struct cb_timing_entry *e = &table[i];
+        if (e->name != name && e->name != NULL)
+            continue;
+
+        e->name = name;
+        e->count++;
+        e->total_cycles += cycles;
+        e->max_cycles = MAX(e->max_cycles, cycles);
+        break;
+    }
+    k_spin_unlock(&lock, key);
+}
+
+void cb_timing_print(void)
+{
+    struct cb_timing_entry copy[CB_TIMING_MAX_CALLBACKS];
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    memcpy(copy, table, sizeof(copy));
+    k_spin_unlock(&lock, key);
+
+    for (int i = 0; i < CB_TIMING_MAX_CALLBACKS && copy[i].name; i++)
+    {
+        const struct cb_timing_entry *e = &copy[i];
+
+        printk("{\"callback\":\"%s\",\"log_mode\":\"%s\",\"dictionary\":%s,\"count\":%u,"
+               "\"avg_us\":%u,\"max_us\":%u}\n",
+               e->name, LOG_MODE, IS_ENABLED(CONFIG_LOG_DICTIONARY_SUPPORT) ? "true" : "false",
+               e->count, k_cyc_to_us_floor32((uint32_t)(e->total_cycles / e->count)),
+               k_cyc_to_us_floor32(e->max_cycles));
+    }
+}
+
+void cb_timing_reset(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    memset(table, 0, sizeof(table));
+    k_spin_unlock(&lock, key);
+}
+
+#else
+
+void cb_timing_print(void)
+{
+}
+
+void cb_timing_reset(void)
+{
+}
+
+#endif /* CONFIG_APP_CB_TIMING */
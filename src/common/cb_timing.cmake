@@ -0,0 +1,5 @@
+# Shared callback timing (cb_timing.c). Include from a sample's CMakeLists.txt
+# after find_package(Zephyr):
+#   include(${CMAKE_CURRENT_SOURCE_DIR}/../common/cb_timing.cmake)
+target_sources(app PRIVATE ${CMAKE_CURRENT_LIST_DIR}/cb_timing.c)
+target_include_directories(app PRIVATE ${CMAKE_CURRENT_LIST_DIR})
@@ -0,0 +1,54 @@
+#ifndef CB_TIMING_H_
+#define CB_TIMING_H_
+
+#include <zephyr/kernel.h>
+
+// Execution time of stack callbacks (Bluetooth connection callbacks and the
+// like), to see what logging from inside them costs:
+//
+//     uint32_t t = cb_timing_start();
+//     ... callback body ...
+//     cb_timing_end("connected", t);
+//
+// Enable with CONFIG_APP_CB_TIMING (../common/cb_timing.conf) and include
+// ../common/cb_timing.cmake. Without the option both calls compile to
+// nothing.
+
+#define CB_TIMING_MAX_CALLBACKS 8
+
+struct cb_timing_entry
+{
+    const char *name; // string literal, compared by address
+    uint32_t count;
+    uint64_t total_cycles;
+    uint32_t max_cycles;
+};
+
+#if defined(CONFIG_APP_CB_TIMING)
+
+static inline uint32_t cb_timing_start(void)
+{
+    return k_cycle_get_32();
+}
+
+void cb_timing_end(const char *name, uint32_t start);
+
+#else
+
+static inline uint32_t cb_timing_start(void)
+{
+    return 0;
+}
+
+static inline void cb_timing_end(const char *name, uint32_t start)
+{
+}
+
+#endif /* CONFIG_APP_CB_TIMING */
+
+// One JSON line per callback, tagged with the logging configuration
+void cb_timing_print(void);
+
+void cb_timing_reset(void);
+
+#endif /* CB_TIMING_H_ */
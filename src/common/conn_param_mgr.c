@@ -0,0 +1,413 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/gap.h>
+#include <string.h>
+
+#include "conn_param_mgr.h"
+
+#define PERIOD_MS CONFIG_APP_CONN_PARAM_MGR_PERIOD_MS
+#define EVENT_US CONFIG_APP_CONN_PARAM_MGR_EVENT_US
+
+// The supervision timeout must be longer than (1 + latency) * interval * 2,
+// in units of 10 ms and 1.25 ms
+BUILD_ASSERT(CONFIG_APP_CONN_PARAM_MGR_TIMEOUT * 4 >
+                 (1 + CONFIG_APP_CONN_PARAM_MGR_IDLE_LATENCY) * CONFIG_APP_CONN_PARAM_MGR_IDLE_MAX,
+             "Supervision timeout too short for the idle parameters");
+
+enum mode
+{
+    MODE_OTHER, // parameters the manager didn't ask for, or nothing pending
+    MODE_IDLE,
+    MODE_FAST,
+    MODES,
+};
+
+static const struct bt_le_conn_param mode_params[MODES] = {
+    [MODE_IDLE] = BT_LE_CONN_PARAM_INIT(CONFIG_APP_CONN_PARAM_MGR_IDLE_MIN,
+                                        CONFIG_APP_CONN_PARAM_MGR_IDLE_MAX,
+                                        CONFIG_APP_CONN_PARAM_MGR_IDLE_LATENCY,
+                                        CONFIG_APP_CONN_PARAM_MGR_TIMEOUT),
+    [MODE_FAST] = BT_LE_CONN_PARAM_INIT(CONFIG_APP_CONN_PARAM_MGR_FAST_MIN,
+                                        CONFIG_APP_CONN_PARAM_MGR_FAST_MAX, 0,
+                                        CONFIG_APP_CONN_PARAM_MGR_TIMEOUT),
+};
+
+struct stats
+{
+    uint32_t mode_ms[MODES];
+    uint32_t requests;
+    uint32_t confirmed;
+    uint32_t unconfirmed; // no le_param_updated with what was asked for in time
+    uint32_t errors;      // bt_conn_le_param_update() failed
+    uint32_t switch_total_ms; // load change to confirmed, over 'confirmed'
+    uint32_t switch_max_ms;
+    uint64_t radio_on_us;
+};
+
+struct slot
+{
+    struct k_work_delayable work;
+
+    // Everything below under 'lock'. 'conn' is set by conn_param_mgr_start()
+    // and cleared by the work handler, which holds the reference.
+    struct bt_conn *conn;
+    bool stopping;
+
+    // Load. Signed, a send callback may come before its conn_param_mgr_tx_queued().
+    int32_t tx_queued;
+    int32_t tx_period; // queued at the start of the period, plus what was added
+    uint32_t rx_period;
+    uint32_t air_bytes; // sent and received since the last estimate
+
+    // Link as last reported
+    uint16_t interval;
+    uint16_t latency;
+    uint8_t phy;
+    enum mode link;
+
+    enum mode wanted;
+    enum mode requested; // MODE_OTHER when no request is out
+    uint32_t quiet_ms;
+    int64_t start_ms;
+    int64_t last_ms;
+    int64_t load_change_ms; // 'wanted' last changed
+    int64_t request_ms;
+    int64_t retry_ms;
+    uint32_t event_acc_us; // time not yet counted as a whole connection event
+    struct stats stats;
+};
+
+static struct slot slots[CONFIG_BT_MAX_CONN];
+static struct k_spinlock lock;
+
+static struct slot *slot_of(const struct bt_conn *conn)
+{
+    uint8_t index = bt_conn_index(conn);
+
+    return index < ARRAY_SIZE(slots) ? &slots[index] : NULL;
+}
+
+static bool in_range(uint16_t interval, const struct bt_le_conn_param *param)
+{
+    return interval >= param->interval_min && interval <= param->interval_max;
+}
+
+static enum mode classify(uint16_t interval, uint16_t latency)
+{
+    for (enum mode m = MODE_IDLE; m < MODES; m++)
+    {
+        if (in_range(interval, &mode_params[m]) && latency == mode_params[m].latency)
+            return m;
+    }
+    return MODE_OTHER;
+}
+
+// Adds the time since the last call to the link's current mode, and
+// estimates the radio-on time of the peripheral over it: one connection
+// event every interval, or every (1 + latency) intervals when nothing
+// moved, plus the air time of the payload bytes. Called with 'lock' held.
+static void account(struct slot *s, int64_t now)
+{
+    uint32_t ms = (uint32_t)(now - s->last_ms);
+    uint32_t period_us = s->interval * 1250U;
+    uint32_t us_per_byte = s->phy == BT_GAP_LE_PHY_2M ? 4 : s->phy == BT_GAP_LE_PHY_CODED ? 64 : 8;
+
+    s->stats.mode_ms[s->link] += ms;
+    s->last_ms = now;
+
+    if (period_us == 0)
+        return;
+    if (s->air_bytes == 0)
+        period_us *= 1 + s->latency;
+
+    // Whole events only, the rest carries over to the next call
+    uint64_t us = (uint64_t)s->event_acc_us + (uint64_t)ms * 1000;
+    s->stats.radio_on_us += us / period_us * EVENT_US;
+    s->event_acc_us = (uint32_t)(us % period_us);
+
+    s->stats.radio_on_us += (uint64_t)s->air_bytes * us_per_byte;
+    s->air_bytes = 0;
+}
+
+static void print_stats(struct bt_conn *conn, uint32_t connected_ms, const struct stats *st)
+{
+    printk("{\"conn\":%u,\"observe\":%s,\"connected_ms\":%u,\"fast_ms\":%u,\"idle_ms\":%u,"
+           "\"other_ms\":%u,\"requests\":%u,\"confirmed\":%u,\"unconfirmed\":%u,\"errors\":%u,"
+           "\"switch_avg_ms\":%u,\"switch_max_ms\":%u,\"radio_on_ms\":%u,\"radio_permille\":%u}\n",
+           bt_conn_index(conn), IS_ENABLED(CONFIG_APP_CONN_PARAM_MGR_OBSERVE) ? "true" : "false",
+           connected_ms, st->mode_ms[MODE_FAST], st->mode_ms[MODE_IDLE], st->mode_ms[MODE_OTHER],
+           st->requests, st->confirmed, st->unconfirmed, st->errors,
+           st->confirmed ? st->switch_total_ms / st->confirmed : 0, st->switch_max_ms,
+           (uint32_t)(st->radio_on_us / 1000),
+           connected_ms ? (uint32_t)(st->radio_on_us / connected_ms) : 0);
+}
+
+// What the load of the last period asks for. Called with 'lock' held.
+static void evaluate(struct slot *s, int64_t now)
+{
+    bool busy = s->tx_period >= CONFIG_APP_CONN_PARAM_MGR_TX_HIGH ||
+                s->rx_period >= CONFIG_APP_CONN_PARAM_MGR_RX_HIGH;
+    bool quiet = s->tx_period <= CONFIG_APP_CONN_PARAM_MGR_TX_LOW &&
+                 s->rx_period <= CONFIG_APP_CONN_PARAM_MGR_RX_LOW;
+    enum mode wanted = s->wanted;
+
+    // A backlog that didn't drain counts again in the next period
+    s->tx_period = MAX(s->tx_queued, 0);
+    s->rx_period = 0;
+
+    if (busy)
+    {
+        s->quiet_ms = 0;
+        wanted = MODE_FAST;
+    }
+    else if (quiet)
+    {
+        s->quiet_ms += PERIOD_MS;
+        if (s->quiet_ms >= CONFIG_APP_CONN_PARAM_MGR_IDLE_HOLD_MS)
+            wanted = MODE_IDLE;
+    }
+    else
+    {
+        // Between the water marks, stay where we are
+        s->quiet_ms = 0;
+    }
+
+    if (wanted != s->wanted)
+    {
+        s->wanted = wanted;
+        s->load_change_ms = now;
+    }
+}
+
+static void period_work_handler(struct k_work *work)
+{
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct slot *s = CONTAINER_OF(dwork, struct slot, work);
+    const struct bt_le_conn_param *param = NULL;
+    int64_t now = k_uptime_get();
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    struct bt_conn *conn = s->conn;
+
+    if (!conn)
+    {
+        k_spin_unlock(&lock, key);
+        return;
+    }
+
+    account(s, now);
+
+    if (s->stopping)
+    {
+        struct stats st = s->stats;
+        uint32_t connected_ms = (uint32_t)(now - s->start_ms);
+
+        s->conn = NULL;
+        k_spin_unlock(&lock, key);
+
+        print_stats(conn, connected_ms, &st);
+        bt_conn_unref(conn);
+        return;
+    }
+
+    evaluate(s, now);
+
+    if (s->requested != MODE_OTHER && now - s->request_ms >= CONFIG_APP_CONN_PARAM_MGR_CONFIRM_MS)
+    {
+        // Rejected, or the central settled on something else. Ask again.
+        s->stats.unconfirmed++;
+        s->requested = MODE_OTHER;
+    }
+
+    if (!IS_ENABLED(CONFIG_APP_CONN_PARAM_MGR_OBSERVE) && s->requested == MODE_OTHER &&
+        s->wanted != MODE_OTHER && s->wanted != s->link && now >= s->retry_ms)
+    {
+        s->requested = s->wanted;
+        s->request_ms = now;
+        s->stats.requests++;
+        param = &mode_params[s->wanted];
+    }
+    k_spin_unlock(&lock, key);
+
+    if (param)
+    {
+        int err = bt_conn_le_param_update(conn, param);
+        if (err)
+        {
+            key = k_spin_lock(&lock);
+            s->stats.errors++;
+            s->requested = MODE_OTHER;
+            s->retry_ms = now + CONFIG_APP_CONN_PARAM_MGR_CONFIRM_MS;
+            k_spin_unlock(&lock, key);
+        }
+    }
+
+    k_work_reschedule(dwork, K_MSEC(PERIOD_MS));
+}
+
+void conn_param_mgr_start(struct bt_conn *conn)
+{
+    struct slot *s = slot_of(conn);
+    struct bt_conn_info info;
+
+    if (!s || bt_conn_get_info(conn, &info) != 0)
+        return;
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    if (s->conn)
+    {
+        // Already managed
+        k_spin_unlock(&lock, key);
+        return;
+    }
+
+    int64_t now = k_uptime_get();
+
+    memset(s, 0, sizeof(*s));
+    k_work_init_delayable(&s->work, period_work_handler);
+    s->conn = bt_conn_ref(conn);
+    s->interval = info.le.interval;
+    s->latency = info.le.latency;
+#if defined(CONFIG_BT_USER_PHY_UPDATE)
+    s->phy = info.le.phy->tx_phy;
+#else
+    s->phy = BT_GAP_LE_PHY_1M;
+#endif
+    s->link = classify(s->interval, s->latency);
+    s->wanted = MODE_OTHER;
+    s->requested = MODE_OTHER;
+    s->start_ms = now;
+    s->last_ms = now;
+    k_spin_unlock(&lock, key);
+
+    k_work_reschedule(&s->work, K_MSEC(PERIOD_MS));
+}
+
+void conn_param_mgr_tx_queued(struct bt_conn *conn, uint32_t len)
+{
+    struct slot *s = slot_of(conn);
+
+    if (!s)
+        return;
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    if (s->conn == conn)
+    {
+        s->tx_queued += (int32_t)len;
+        s->tx_period += (int32_t)len;
+    }
+    k_spin_unlock(&lock, key);
+}
+
+void conn_param_mgr_tx_done(struct bt_conn *conn, uint32_t len)
+{
+    struct slot *s = slot_of(conn);
+
+    if (!s)
+        return;
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    if (s->conn == conn)
+    {
+        s->tx_queued -= (int32_t)len;
+        s->air_bytes += len;
+    }
+    k_spin_unlock(&lock, key);
+}
+
+void conn_param_mgr_rx(struct bt_conn *conn, uint32_t len)
+{
+    struct slot *s = slot_of(conn);
+
+    if (!s)
+        return;
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    if (s->conn == conn)
+    {
+        s->rx_period += len;
+        s->air_bytes += len;
+    }
+    k_spin_unlock(&lock, key);
+}
+
+static void on_param_updated(struct bt_conn *conn, uint16_t interval, uint16_t latency,
+                             uint16_t timeout)
+{
+    struct slot *s = slot_of(conn);
+
+    if (!s)
+        return;
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    if (s->conn == conn && !s->stopping)
+    {
+        int64_t now = k_uptime_get();
+
+        // The time so far still ran on the old parameters
+        account(s, now);
+        s->interval = interval;
+        s->latency = latency;
+        s->link = classify(interval, latency);
+
+        if (s->requested != MODE_OTHER && s->link == s->requested)
+        {
+            uint32_t ms = (uint32_t)(now - s->load_change_ms);
+
+            s->stats.confirmed++;
+            s->stats.switch_total_ms += ms;
+            s->stats.switch_max_ms = MAX(s->stats.switch_max_ms, ms);
+            s->requested = MODE_OTHER;
+        }
+    }
+    k_spin_unlock(&lock, key);
+}
+
+#if defined(CONFIG_BT_USER_PHY_UPDATE)
+static void on_phy_updated(struct bt_conn *conn, struct bt_conn_le_phy_info *info)
+{
+    struct slot *s = slot_of(conn);
+
+    if (!s)
+        return;
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    if (s->conn == conn && !s->stopping)
+    {
+        account(s, k_uptime_get());
+        s->phy = info->tx_phy;
+    }
+    k_spin_unlock(&lock, key);
+}
+#endif
+
+static void on_disconnected(struct bt_conn *conn, uint8_t reason)
+{
+    struct slot *s = slot_of(conn);
+    bool managed = false;
+
+    if (!s)
+        return;
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    if (s->conn == conn)
+    {
+        s->stopping = true;
+        managed = true;
+    }
+    k_spin_unlock(&lock, key);
+
+    // The work handler prints the report and drops the reference
+    if (managed)
+        k_work_reschedule(&s->work, K_NO_WAIT);
+}
+
+BT_CONN_CB_DEFINE(conn_param_mgr_callbacks) = {
+    .disconnected = on_disconnected,
+    .le_param_updated = on_param_updated,
+#if defined(CONFIG_BT_USER_PHY_UPDATE)
+    .le_phy_updated = on_phy_updated,
+#endif
+};
@@ -0,0 +1,7 @@
+# Shared load-adaptive connection parameters (conn_param_mgr.c). Include from
+# a sample's CMakeLists.txt after find_package(Zephyr):
+#   include(${CMAKE_CURRENT_SOURCE_DIR}/../common/conn_param_mgr.cmake)
+if(CONFIG_APP_CONN_PARAM_MGR)
+  target_sources(app PRIVATE ${CMAKE_CURRENT_LIST_DIR}/conn_param_mgr.c)
+endif()
+target_include_directories(app PRIVATE ${CMAKE_CURRENT_LIST_DIR})
@@ -0,0 +1,68 @@
+#ifndef CONN_PARAM_MGR_H_
+#define CONN_PARAM_MGR_H_
+
+#include <zephyr/bluetooth/conn.h>
+
+// Picks the connection parameters from the load of the connection instead
+// of leaving it at whatever was negotiated at connect time. While data is
+// queued or arriving it asks for a short interval without peripheral
+// latency (FAST), and once the connection has been quiet for a while, for
+// a long interval with latency (IDLE):
+//
+//     conn_param_mgr_start(conn);             // once the link is set up
+//     conn_param_mgr_tx_queued(conn, len);    // notification queued
+//     conn_param_mgr_tx_done(conn, len);      // ... and sent
+//     conn_param_mgr_rx(conn, len);           // write received
+//
+// The load, bytes queued for sending (plus what is still queued from
+// before) and bytes received, is sampled every
+// CONFIG_APP_CONN_PARAM_MGR_PERIOD_MS. Going to FAST takes one period above
+// either high water mark. Going back to IDLE takes
+// CONFIG_APP_CONN_PARAM_MGR_IDLE_HOLD_MS below both low water marks, so a
+// stream with short gaps doesn't flip the interval back and forth. A switch
+// counts once le_param_updated reports the new parameters; one that isn't
+// confirmed within CONFIG_APP_CONN_PARAM_MGR_CONFIRM_MS is asked for again.
+//
+// On disconnect, prints one JSON line with the time spent in each mode,
+// the switch latency and an estimate of the peripheral's radio-on time.
+//
+// Enable with CONFIG_APP_CONN_PARAM_MGR and include
+// ../common/conn_param_mgr.cmake. The stack's own parameter update
+// (CONFIG_BT_GAP_AUTO_UPDATE_CONN_PARAMS) must be off. Without the option
+// the calls compile to nothing.
+
+#if defined(CONFIG_APP_CONN_PARAM_MGR)
+
+// Starts managing 'conn' until it disconnects
+void conn_param_mgr_start(struct bt_conn *conn);
+
+// 'len' bytes handed to the stack for 'conn'. Any context.
+void conn_param_mgr_tx_queued(struct bt_conn *conn, uint32_t len);
+
+// 'len' of the queued bytes sent. Any context.
+void conn_param_mgr_tx_done(struct bt_conn *conn, uint32_t len);
+
+// 'len' bytes received on 'conn'. Any context.
+void conn_param_mgr_rx(struct bt_conn *conn, uint32_t len);
+
+#else
+
+static inline void conn_param_mgr_start(struct bt_conn *conn)
+{
+}
+
+static inline void conn_param_mgr_tx_queued(struct bt_conn *conn, uint32_t len)
+{
+}
+
+static inline void conn_param_mgr_tx_done(struct bt_conn *conn, uint32_t len)
+{
+}
+
+static inline void conn_param_mgr_rx(struct bt_conn *conn, uint32_t len)
+{
+}
+
+#endif /* CONFIG_APP_CONN_PARAM_MGR */
+
+#endif /* CONN_PARAM_MGR_H_ */
@@ -0,0 +1,271 @@
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/sys/iterable_sections.h>
+#include <zephyr/sys/printk.h>
+#include <string.h>
+
+#include "mutex_prof.h"
+
+#if defined(CONFIG_APP_MUTEX_PROF)
+
+// K_MUTEX_DEFINE() places every mutex in one linker section, so a mutex's
+// position in that section is its index in the table
+STRUCT_SECTION_START_EXTERN(k_mutex);
+STRUCT_SECTION_END_EXTERN(k_mutex);
+
+static struct mutex_prof_entry table[MUTEX_PROF_MAX_MUTEXES];
+static struct k_spinlock lock;
+
+static const uint32_t bucket_limit_us[MUTEX_PROF_BUCKETS - 1] = {10, 100, 1000, 10000, 100000};
+
+static struct k_work_delayable report_work;
+
+// The real kernel functions, renamed by -Wl,--wrap (see mutex_prof.cmake)
+int __real_z_impl_k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout);
+int __real_z_impl_k_mutex_unlock(struct k_mutex *mutex);
+
+static struct mutex_prof_entry *entry_for(const struct k_mutex *mutex)
+{
+    if (mutex < STRUCT_SECTION_START(k_mutex) || mutex >= STRUCT_SECTION_END(k_mutex))
+        return NULL; // not from K_MUTEX_DEFINE()
+
+    ptrdiff_t index = mutex - STRUCT_SECTION_START(k_mutex);
+    if (index >= MUTEX_PROF_MAX_MUTEXES)
+        return NULL;
+
+    return &table[index];
+}
+
+static int bucket_for(uint32_t us)
+{
+    int b = 0;
+    while (b < MUTEX_PROF_BUCKETS - 1 && us >= bucket_limit_us[b])
+        b++;
+    return b;
+}
+
+// Caller holds the lock. With more holders than slots, a new thread takes
+// the slot with the least total hold time once it has held the mutex longer.
+static void record_holder(struct mutex_prof_entry *e, const struct k_thread *thread,
+                          uint32_t hold_us)
+{
+    struct mutex_prof_holder *slot = NULL;
+    struct mutex_prof_holder *least = &e->top[0];
+
+    for (int i = 0; i < MUTEX_PROF_TOP_HOLDERS; i++)
+    {
+        struct mutex_prof_holder *h = &e->top[i];
+        if (h->thread == thread || h->thread == NULL)
+        {
+            slot = h;
+            break;
+        }
+        if (h->total_hold_us < least->total_hold_us)
+            least = h;
+    }
+
+    if (!slot)
+    {
+        if (hold_us <= least->total_hold_us)
+            return;
+        slot = least;
+        memset(slot, 0, sizeof(*slot));
+    }
+
+    slot->thread = thread;
+    slot->count++;
+    slot->total_hold_us += hold_us;
+    if (hold_us > slot->max_hold_us)
+        slot->max_hold_us = hold_us;
+}
+
+int __wrap_z_impl_k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout)
+{
+    struct mutex_prof_entry *e = entry_for(mutex);
+    if (!e)
+        return __real_z_impl_k_mutex_lock(mutex, timeout);
+
+    // Racy read on SMP, good enough for a statistic
+    bool contended = mutex->owner != NULL && mutex->owner != k_current_get();
+    uint32_t start = k_cycle_get_32();
+
+    int ret = __real_z_impl_k_mutex_lock(mutex, timeout);
+
+    uint32_t now = k_cycle_get_32();
+    uint32_t wait_us = k_cyc_to_us_floor32(now - start);
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    e->mutex = mutex;
+    if (contended)
+        e->contended++;
+    if (ret != 0)
+    {
+        e->timeouts++;
+    }
+    else
+    {
+        e->acquired++;
+        e->wait_hist[bucket_for(wait_us)]++;
+        if (wait_us > e->max_wait_us)
+            e->max_wait_us = wait_us;
+
+        // Recursive locks extend the outermost hold
+        if (mutex->lock_count == 1)
+            e->hold_start = now;
+    }
+    k_spin_unlock(&lock, key);
+
+    return ret;
+}
+
+int __wrap_z_impl_k_mutex_unlock(struct k_mutex *mutex)
+{
+    struct mutex_prof_entry *e = entry_for(mutex);
+
+    if (e && mutex->owner == k_current_get() && mutex->lock_count == 1)
+    {
+        uint32_t hold_us = k_cyc_to_us_floor32(k_cycle_get_32() - e->hold_start);
+
+        k_spinlock_key_t key = k_spin_lock(&lock);
+        e->hold_hist[bucket_for(hold_us)]++;
+        if (hold_us > e->max_hold_us)
+            e->max_hold_us = hold_us;
+        record_holder(e, k_current_get(), hold_us);
+        k_spin_unlock(&lock, key);
+    }
+
+    return __real_z_impl_k_mutex_unlock(mutex);
+}
+
+void mutex_prof_name_set(const struct k_mutex *mutex, const char *name)
+{
+    struct mutex_prof_entry *e = entry_for(mutex);
+    if (!e)
+        return;
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    e->mutex = mutex;
+    e->name = name;
+    k_spin_unlock(&lock, key);
+}
+
+bool mutex_prof_get(int index, struct mutex_prof_entry *out)
+{
+    size_t count;
+
+    STRUCT_SECTION_COUNT(k_mutex, &count);
+    if (index < 0 || (size_t)index >= MIN(count, MUTEX_PROF_MAX_MUTEXES))
+        return false;
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    *out = table[index];
+    k_spin_unlock(&lock, key);
+
+    out->mutex = &STRUCT_SECTION_START(k_mutex)[index];
+
+    // Most hold time first
+    for (int i = 1; i < MUTEX_PROF_TOP_HOLDERS; i++)
+    {
+        struct mutex_prof_holder h = out->top[i];
+        int j = i;
+        while (j > 0 && out->top[j - 1].total_hold_us < h.total_hold_us)
+        {
+            out->top[j] = out->top[j - 1];
+            j--;
+        }
+        out->top[j] = h;
+    }
+    return true;
+}
+
+void mutex_prof_reset(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    for (int i = 0; i < MUTEX_PROF_MAX_MUTEXES; i++)
+    {
+        struct mutex_prof_entry *e = &table[i];
+        const char *name = e->name;
+        uint32_t hold_start = e->hold_start; // a hold may be in progress
+
+        memset(e, 0, sizeof(*e));
+        e->name = name;
+        e->hold_start = hold_start;
+    }
+    k_spin_unlock(&lock, key);
+}
+
+static void report_work_handler(struct k_work *work)
+{
+    mutex_prof_print();
+    k_work_schedule(&report_work, K_MSEC(CONFIG_APP_MUTEX_PROF_PERIOD_MS));
+}
+
+static int mutex_prof_init(void)
+{
+    if (CONFIG_APP_MUTEX_PROF_PERIOD_MS > 0)
+    {
+        k_work_init_delayable(&report_work, report_work_handler);
+        k_work_schedule(&report_work, K_MSEC(CONFIG_APP_MUTEX_PROF_PERIOD_MS));
+    }
+    return 0;
+}
+
+SYS_INIT(mutex_prof_init, APPLICATION, 99);
+
+#else
+
+bool mutex_prof_get(int index, struct mutex_prof_entry *out)
+{
+    return false;
+}
+
+void mutex_prof_reset(void)
+{
+}
+
+#endif /* CONFIG_APP_MUTEX_PROF */
+
+static void print_hist(const char *label, uint32_t max_us, const uint32_t *hist)
+{
+    printk("  %-4s max %6u us  %u/%u/%u/%u/%u/%u\n", label, max_us, hist[0], hist[1], hist[2],
+           hist[3], hist[4], hist[5]);
+}
+
+void mutex_prof_print(void)
+{
+    struct mutex_prof_entry e;
+
+    if (!IS_ENABLED(CONFIG_APP_MUTEX_PROF))
+    {
+        printk("mutex profile disabled, build with CONFIG_APP_MUTEX_PROF=y\n");
+        return;
+    }
+
+    printk("mutex profile (buckets <10us/<100us/<1ms/<10ms/<100ms/more)\n");
+    for (int i = 0; mutex_prof_get(i, &e); i++)
+    {
+        if (e.acquired == 0 && e.timeouts == 0)
+            continue;
+
+        if (e.name)
+            printk("%s: ", e.name);
+        else
+            printk("%p: ", e.mutex);
+        printk("acquired %u, contended %u, timeouts %u\n", e.acquired, e.contended, e.timeouts);
+        print_hist("wait", e.max_wait_us, e.wait_hist);
+        print_hist("hold", e.max_hold_us, e.hold_hist);
+
+        for (int h = 0; h < MUTEX_PROF_TOP_HOLDERS && e.top[h].thread; h++)
+        {
+            const struct mutex_prof_holder *holder = &e.top[h];
+            const char *name = k_thread_name_get((k_tid_t)holder->thread);
+
+            if (name && name[0])
+                printk("  held by %-16s", name);
+            else
+                printk("  held by %p", holder->thread);
+            printk(" %6u times, avg %u us, max %u us\n", holder->count,
+                   (uint32_t)(holder->total_hold_us / holder->count), holder->max_hold_us);
+        }
+    }
+}
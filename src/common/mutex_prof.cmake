@@ -0,0 +1,13 @@
+# Shared mutex profiler (mutex_prof.c). Include from a sample's CMakeLists.txt
+# after find_package(Zephyr):
+#   include(${CMAKE_CURRENT_SOURCE_DIR}/../common/mutex_prof.cmake)
+target_sources(app PRIVATE ${CMAKE_CURRENT_LIST_DIR}/mutex_prof.c)
+target_include_directories(app PRIVATE ${CMAKE_CURRENT_LIST_DIR})
+
+# Route every k_mutex_lock()/k_mutex_unlock() through the profiler
+if(CONFIG_APP_MUTEX_PROF)
+  zephyr_ld_options(
+    -Wl,--wrap=z_impl_k_mutex_lock
+    -Wl,--wrap=z_impl_k_mutex_unlock
+  )
+endif()
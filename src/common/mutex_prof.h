@@ -0,0 +1,73 @@
+#ifndef MUTEX_PROF_H_
+#define MUTEX_PROF_H_
+
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+
+// Hold-time and wait-time profile of every mutex defined with
+// K_MUTEX_DEFINE(), no code changes needed: mutex_prof.cmake wraps the
+// kernel's k_mutex_lock()/k_mutex_unlock() at link time. Build with
+// -DEXTRA_CONF_FILE=../common/mutex_prof.conf (CONFIG_APP_MUTEX_PROF).
+// Mutexes set up with k_mutex_init() at run time are not tracked.
+
+#define MUTEX_PROF_MAX_MUTEXES 16
+#define MUTEX_PROF_TOP_HOLDERS 4
+
+// Time buckets: <10 us, <100 us, <1 ms, <10 ms, <100 ms, longer
+#define MUTEX_PROF_BUCKETS 6
+
+struct mutex_prof_holder
+{
+    const struct k_thread *thread;
+    uint32_t count;
+    uint32_t max_hold_us;
+    uint64_t total_hold_us;
+};
+
+struct mutex_prof_entry
+{
+    const struct k_mutex *mutex;
+    const char *name;      // set with MUTEX_PROF_NAME(), or NULL
+    uint32_t acquired;
+    uint32_t contended;    // the mutex was held by another thread on entry
+    uint32_t timeouts;     // k_mutex_lock() gave up
+    uint32_t max_wait_us;
+    uint32_t max_hold_us;
+    uint32_t wait_hist[MUTEX_PROF_BUCKETS];
+    uint32_t hold_hist[MUTEX_PROF_BUCKETS];
+    struct mutex_prof_holder top[MUTEX_PROF_TOP_HOLDERS]; // by total hold time
+
+    // Private
+    uint32_t hold_start;
+};
+
+#if defined(CONFIG_APP_MUTEX_PROF)
+
+void mutex_prof_name_set(const struct k_mutex *mutex, const char *name);
+
+// Gives a K_MUTEX_DEFINE() mutex a readable name in the report. Use at file
+// scope, next to the definition.
+#define MUTEX_PROF_NAME(_mutex)                                     \
+    static int _mutex##_prof_name(void)                             \
+    {                                                               \
+        mutex_prof_name_set(&_mutex, #_mutex);                      \
+        return 0;                                                   \
+    }                                                               \
+    SYS_INIT(_mutex##_prof_name, APPLICATION, 0)
+
+#else
+
+#define MUTEX_PROF_NAME(_mutex)
+
+#endif /* CONFIG_APP_MUTEX_PROF */
+
+// Copy out the profile of mutex 'index'. Returns false past the end, or
+// when CONFIG_APP_MUTEX_PROF is off.
+bool mutex_prof_get(int index, struct mutex_prof_entry *out);
+
+void mutex_prof_reset(void);
+
+// Print the profile of every mutex that has been locked, with printk()
+void mutex_prof_print(void);
+
+#endif /* MUTEX_PROF_H_ */
@@ -0,0 +1,183 @@
+#include <errno.h>
+#include <string.h>
+
+#include "ndef_builder.h"
+
+#define TEXT_LANG_MAX 0x3F // the status byte has 6 bits for the length
+
+static size_t header_len(const struct ndef_builder_record *rec)
+{
+    return 2 + (rec->payload_max < 256 ? 1 : 4) + rec->type_len;
+}
+
+static uint8_t *msg(const struct ndef_builder *b)
+{
+    return b->buf + b->prefix;
+}
+
+static void write_nlen(struct ndef_builder *b)
+{
+    if (b->prefix)
+    {
+        b->buf[0] = (uint8_t)(b->len >> 8);
+        b->buf[1] = (uint8_t)b->len;
+    }
+}
+
+static void write_payload_len(struct ndef_builder *b, const struct ndef_builder_record *rec)
+{
+    uint8_t *field = msg(b) + rec->offset + 2;
+
+    if (rec->payload_max < 256)
+    {
+        field[0] = (uint8_t)rec->payload_len;
+    }
+    else
+    {
+        field[0] = 0;
+        field[1] = 0;
+        field[2] = (uint8_t)(rec->payload_len >> 8);
+        field[3] = (uint8_t)rec->payload_len;
+    }
+}
+
+// Keeps the first 'keep' payload bytes of record 'index' and replaces the
+// rest with 'data'. Records behind it move when the payload length changes.
+static int patch_payload(struct ndef_builder *b, int index, size_t keep, const void *data,
+                         size_t len)
+{
+    if (index < 0 || index >= b->count)
+        return -EINVAL;
+
+    struct ndef_builder_record *rec = &b->records[index];
+    size_t new_len = keep + len;
+    if (keep > rec->payload_len)
+        return -EINVAL;
+    if (new_len > rec->payload_max)
+        return -E2BIG;
+
+    uint8_t *m = msg(b);
+    size_t payload = rec->offset + header_len(rec);
+    size_t old_end = payload + rec->payload_len;
+    size_t new_end = payload + new_len;
+
+    if (new_end != old_end)
+    {
+        memmove(m + new_end, m + old_end, b->len - old_end);
+        for (int i = index + 1; i < b->count; i++)
+        {
+            b->records[i].offset = (uint16_t)(b->records[i].offset + new_end - old_end);
+        }
+        b->len = b->len + new_end - old_end;
+        rec->payload_len = (uint16_t)new_len;
+        write_payload_len(b, rec);
+        write_nlen(b);
+    }
+
+    if (len)
+        memcpy(m + payload + keep, data, len);
+    return 0;
+}
+
+void ndef_builder_init(struct ndef_builder *b, uint8_t *buf, size_t size, bool nlen)
+{
+    memset(b, 0, sizeof(*b));
+    b->buf = buf;
+    b->size = size;
+    b->prefix = nlen ? 2 : 0;
+    write_nlen(b);
+}
+
+int ndef_builder_add(struct ndef_builder *b, enum ndef_tnf tnf, const void *type,
+                     uint8_t type_len, const void *payload, size_t payload_len,
+                     size_t payload_max)
+{
+    if (b->count >= NDEF_BUILDER_MAX_RECORDS)
+        return -ENOMEM;
+    if (payload_len > payload_max || payload_max > UINT16_MAX)
+        return -EINVAL;
+
+    struct ndef_builder_record *rec = &b->records[b->count];
+    rec->offset = (uint16_t)b->len;
+    rec->payload_len = (uint16_t)payload_len;
+    rec->payload_max = (uint16_t)payload_max;
+    rec->type_len = type_len;
+
+    size_t hdr = header_len(rec);
+    if (b->prefix + b->max_len + hdr + payload_max > b->size)
+        return -E2BIG;
+
+    uint8_t *m = msg(b);
+    uint8_t *p = m + rec->offset;
+
+    // The new record ends the message
+    if (b->count > 0)
+        m[b->records[b->count - 1].offset] &= (uint8_t)~NDEF_FLAG_ME;
+
+    p[0] = (uint8_t)((tnf & NDEF_TNF_MASK) | NDEF_FLAG_ME | (b->count == 0 ? NDEF_FLAG_MB : 0) |
+                     (payload_max < 256 ? NDEF_FLAG_SR : 0));
+    p[1] = type_len;
+    write_payload_len(b, rec);
+    memcpy(p + hdr - type_len, type, type_len);
+    if (payload_len)
+        memcpy(p + hdr, payload, payload_len);
+
+    b->len += hdr + payload_len;
+    b->max_len += hdr + payload_max;
+    write_nlen(b);
+    return b->count++;
+}
+
+int ndef_builder_add_text(struct ndef_builder *b, const char *lang, const char *text,
+                          size_t text_max)
+{
+    size_t lang_len = strlen(lang);
+    size_t text_len = strlen(text);
+    uint8_t head[1 + TEXT_LANG_MAX];
+
+    if (lang_len > TEXT_LANG_MAX || text_len > text_max)
+        return -EINVAL;
+
+    // Status byte: bit 7 clear for UTF-8, then the language code length
+    head[0] = (uint8_t)lang_len;
+    memcpy(&head[1], lang, lang_len);
+
+    int index = ndef_builder_add(b, NDEF_TNF_WELL_KNOWN, "T", 1, head, 1 + lang_len,
+                                 1 + lang_len + text_max);
+    if (index < 0)
+        return index;
+
+    patch_payload(b, index, 1 + lang_len, text, text_len);
+    return index;
+}
+
+int ndef_builder_set_payload(struct ndef_builder *b, int index, const void *payload, size_t len)
+{
+    return patch_payload(b, index, 0, payload, len);
+}
+
+int ndef_builder_set_text(struct ndef_builder *b, int index, const char *text, size_t len)
+{
+    if (index < 0 || index >= b->count)
+        return -EINVAL;
+
+    const struct ndef_builder_record *rec = &b->records[index];
+    uint8_t status = msg(b)[rec->offset + header_len(rec)];
+
+    return patch_payload(b, index, 1 + (status & TEXT_LANG_MAX), text, len);
+}
+
+int ndef_builder_copy(struct ndef_builder *dst, const struct ndef_builder *src)
+{
+    if (src->prefix + src->max_len > dst->size)
+        return -E2BIG;
+
+    uint8_t *buf = dst->buf;
+    size_t size = dst->size;
+
+    *dst = *src;
+    dst->buf = buf;
+    dst->size = size;
+    memcpy(dst->buf, src->buf, ndef_builder_len(src));
+    return 0;
+}
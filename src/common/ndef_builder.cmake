@@ -0,0 +1,5 @@
+# Shared NDEF message builder (ndef_builder.c). Include from a sample's
+# CMakeLists.txt after find_package(Zephyr):
+#   include(${CMAKE_CURRENT_SOURCE_DIR}/../common/ndef_builder.cmake)
+target_sources(app PRIVATE ${CMAKE_CURRENT_LIST_DIR}/ndef_builder.c)
+target_include_directories(app PRIVATE ${CMAKE_CURRENT_LIST_DIR})
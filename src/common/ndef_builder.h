@@ -0,0 +1,95 @@
+#ifndef NDEF_BUILDER_H_
+#define NDEF_BUILDER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// NDEF message builder that remembers where every record sits, so one
+// record's payload can be replaced later by patching its bytes and length
+// fields instead of encoding the whole message again. Plain C without
+// kernel calls, so it also runs in native_sim benchmarks.
+// Include ../common/ndef_builder.cmake from the app.
+//
+// A record's length field is sized once, from the largest payload it will
+// ever carry ('payload_max'), so updates never change the record layout.
+// Only the bytes after a record whose payload length changes move.
+//
+// For a Type 4 Tag NDEF file, init with 'nlen' set: the message is then
+// preceded by the 2-byte NLEN field, kept up to date on every change.
+
+#define NDEF_BUILDER_MAX_RECORDS 8
+
+enum ndef_tnf
+{
+    NDEF_TNF_EMPTY = 0x00,
+    NDEF_TNF_WELL_KNOWN = 0x01,
+    NDEF_TNF_MIME = 0x02,
+    NDEF_TNF_URI = 0x03,
+    NDEF_TNF_EXTERNAL = 0x04,
+};
+
+// Record header flags
+#define NDEF_FLAG_MB 0x80
+#define NDEF_FLAG_ME 0x40
+#define NDEF_FLAG_CF 0x20
+#define NDEF_FLAG_SR 0x10
+#define NDEF_FLAG_IL 0x08
+#define NDEF_TNF_MASK 0x07
+
+struct ndef_builder_record
+{
+    uint16_t offset;      // header byte, from the start of the message
+    uint16_t payload_len;
+    uint16_t payload_max;
+    uint8_t type_len;
+};
+
+struct ndef_builder
+{
+    uint8_t *buf;
+    size_t size;
+    size_t prefix;  // NLEN bytes in front of the message, 0 or 2
+    size_t len;     // message bytes after the prefix
+    size_t max_len; // message bytes with every payload at its maximum
+    int count;
+    struct ndef_builder_record records[NDEF_BUILDER_MAX_RECORDS];
+};
+
+void ndef_builder_init(struct ndef_builder *b, uint8_t *buf, size_t size, bool nlen);
+
+// Appends a record, returns its index or -ENOMEM (no record slot left) or
+// -E2BIG (the buffer can't hold every record at its payload_max)
+int ndef_builder_add(struct ndef_builder *b, enum ndef_tnf tnf, const void *type,
+                     uint8_t type_len, const void *payload, size_t payload_len,
+                     size_t payload_max);
+
+// Well-known Text record in UTF-8, room for up to 'text_max' bytes of text
+int ndef_builder_add_text(struct ndef_builder *b, const char *lang, const char *text,
+                          size_t text_max);
+
+// Replaces a record's payload. -EINVAL for a bad index, -E2BIG beyond the
+// record's payload_max.
+int ndef_builder_set_payload(struct ndef_builder *b, int index, const void *payload,
+                             size_t len);
+
+// Replaces the text of a record added with ndef_builder_add_text(),
+// keeping its language code
+int ndef_builder_set_text(struct ndef_builder *b, int index, const char *text, size_t len);
+
+// Copies the message and record table of 'src' into the buffer of 'dst',
+// which needs room for src->max_len like the buffer of 'src' has
+int ndef_builder_copy(struct ndef_builder *dst, const struct ndef_builder *src);
+
+// The encoded message, including the NLEN prefix if there is one
+static inline const uint8_t *ndef_builder_data(const struct ndef_builder *b)
+{
+    return b->buf;
+}
+
+static inline size_t ndef_builder_len(const struct ndef_builder *b)
+{
+    return b->prefix + b->len;
+}
+
+#endif /* NDEF_BUILDER_H_ */
@@ -0,0 +1,83 @@
+#include <errno.h>
+#include <string.h>
+
+#include "ndef_parse.h"
+
+void ndef_parser_init(struct ndef_parser *p, const uint8_t *data, size_t len)
+{
+    p->data = data;
+    p->len = len;
+    p->pos = 0;
+    p->done = false;
+}
+
+int ndef_parser_next(struct ndef_parser *p, struct ndef_record *rec)
+{
+    if (p->done)
+        return 0;
+
+    const uint8_t *d = p->data + p->pos;
+    size_t left = p->len - p->pos;
+
+    if (left < 3)
+        return -EBADMSG;
+
+    rec->header = d[0];
+    rec->tnf = d[0] & NDEF_TNF_MASK;
+    rec->type_len = d[1];
+
+    if (rec->header & NDEF_FLAG_CF)
+        return -ENOTSUP;
+    if (!(rec->header & NDEF_FLAG_MB) != (p->pos != 0))
+        return -EBADMSG; // MB on the first record and only there
+
+    size_t hdr = 2;
+    if (rec->header & NDEF_FLAG_SR)
+    {
+        rec->payload_len = d[2];
+        hdr += 1;
+    }
+    else
+    {
+        if (left < 6)
+            return -EBADMSG;
+        rec->payload_len = (uint32_t)d[2] << 24 | (uint32_t)d[3] << 16 | (uint32_t)d[4] << 8 | d[5];
+        hdr += 4;
+    }
+
+    rec->id_len = 0;
+    if (rec->header & NDEF_FLAG_IL)
+    {
+        if (left < hdr + 1)
+            return -EBADMSG;
+        rec->id_len = d[hdr];
+        hdr += 1;
+    }
+
+    // Checked one field at a time, so a huge payload length can't wrap a sum
+    left -= hdr;
+    if (rec->type_len > left)
+        return -EBADMSG;
+    left -= rec->type_len;
+    if (rec->id_len > left)
+        return -EBADMSG;
+    left -= rec->id_len;
+    if (rec->payload_len > left)
+        return -EBADMSG;
+
+    rec->type = d + hdr;
+    rec->id = rec->type + rec->type_len;
+    rec->payload = rec->id + rec->id_len;
+
+    p->pos = (size_t)(rec->payload + rec->payload_len - p->data);
+    if (rec->header & NDEF_FLAG_ME)
+        p->done = true;
+    return 1;
+}
+
+bool ndef_record_is(const struct ndef_record *rec, enum ndef_tnf tnf, const char *type)
+{
+    size_t len = strlen(type);
+
+    return rec->tnf == tnf && rec->type_len == len && memcmp(rec->type, type, len) == 0;
+}
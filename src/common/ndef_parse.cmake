@@ -0,0 +1,5 @@
+# Shared NDEF record parser (ndef_parse.c). Include from a sample's
+# CMakeLists.txt after find_package(Zephyr):
+#   include(${CMAKE_CURRENT_SOURCE_DIR}/../common/ndef_parse.cmake)
+target_sources(app PRIVATE ${CMAKE_CURRENT_LIST_DIR}/ndef_parse.c)
+target_include_directories(app PRIVATE ${CMAKE_CURRENT_LIST_DIR})
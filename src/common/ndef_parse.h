@@ -0,0 +1,45 @@
+#ifndef NDEF_PARSE_H_
+#define NDEF_PARSE_H_
+
+#include "ndef_builder.h" // enum ndef_tnf, NDEF_FLAG_*
+
+// Bounds-checked NDEF record iterator for messages written by a reader,
+// which can hold anything. Plain C like ndef_builder.c. Include
+// ../common/ndef_parse.cmake from the app.
+
+struct ndef_record
+{
+    uint8_t header; // MB/ME/CF/SR/IL flags and TNF
+    uint8_t tnf;
+    uint8_t type_len;
+    uint8_t id_len;
+    const uint8_t *type;
+    const uint8_t *id;
+    const uint8_t *payload;
+    uint32_t payload_len;
+};
+
+struct ndef_parser
+{
+    const uint8_t *data;
+    size_t len;
+    size_t pos;
+    bool done;
+};
+
+void ndef_parser_init(struct ndef_parser *p, const uint8_t *data, size_t len);
+
+// Returns 1 with the next record in 'rec', 0 after the last (ME) record,
+// -EBADMSG if the message is truncated or its MB/ME flags are wrong, or
+// -ENOTSUP for chunked records. Points into the message, copies nothing.
+int ndef_parser_next(struct ndef_parser *p, struct ndef_record *rec);
+
+// True if the record has the given TNF and type
+bool ndef_record_is(const struct ndef_record *rec, enum ndef_tnf tnf, const char *type);
+
+// Fuzz harness in ndef_parse_fuzz.c: walks 'data' like a message written by
+// a reader, aborts if a record reaches outside it, and returns the number
+// of records or the parser's error
+int ndef_parse_fuzz_one(const uint8_t *data, size_t size);
+
+#endif /* NDEF_PARSE_H_ */
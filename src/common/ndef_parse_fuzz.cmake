@@ -0,0 +1,7 @@
+# libFuzzer entry point for the NDEF parser (ndef_parse_fuzz.c). Include from
+# a sample's CMakeLists.txt after find_package(Zephyr):
+#   include(${CMAKE_CURRENT_SOURCE_DIR}/../common/ndef_parse_fuzz.cmake)
+target_sources(app PRIVATE ${CMAKE_CURRENT_LIST_DIR}/ndef_parse_fuzz.c)
+target_include_directories(app PRIVATE ${CMAKE_CURRENT_LIST_DIR})
+
+include(${CMAKE_CURRENT_LIST_DIR}/ndef_parse.cmake)
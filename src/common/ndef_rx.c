@@ -0,0 +1,130 @@
+#include <zephyr/kernel.h>
+#include <string.h>
+
+#include "buf_pipe.h"
+#include "ndef_rx.h"
+
+#define NDEF_RX_STACK_SIZE 1024
+#define MAX_BATCH 4
+
+BUF_PIPE_DEFINE(shadow, CONFIG_APP_NDEF_RX_BUF_SIZE, CONFIG_APP_NDEF_RX_BUFS);
+
+K_THREAD_STACK_DEFINE(ndef_rx_stack, NDEF_RX_STACK_SIZE);
+static struct k_work_q ndef_rx_q;
+static struct k_work process_work;
+
+static sys_slist_t consumers;
+static struct ndef_rx_stats stats;
+static struct k_spinlock lock;
+
+static void dispatch(const struct ndef_record *rec)
+{
+    struct ndef_rx_consumer *c;
+
+    SYS_SLIST_FOR_EACH_CONTAINER(&consumers, c, node)
+    {
+        if (rec->tnf == c->tnf && (!c->type || ndef_record_is(rec, c->tnf, c->type)))
+            c->handler(rec, c->user_data);
+    }
+}
+
+static void process(const struct buf_pipe_buf *buf)
+{
+    struct ndef_parser parser;
+    struct ndef_record rec;
+    uint32_t records = 0;
+    uint32_t start = k_cycle_get_32();
+    int ret;
+
+    ndef_parser_init(&parser, buf->data, buf->len);
+    while ((ret = ndef_parser_next(&parser, &rec)) == 1)
+    {
+        dispatch(&rec);
+        records++;
+    }
+
+    uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    stats.records += records;
+    if (ret < 0)
+        stats.malformed++;
+    else
+        stats.messages++;
+    stats.max_process_us = MAX(stats.max_process_us, us);
+    k_spin_unlock(&lock, key);
+}
+
+static void process_work_handler(struct k_work *work)
+{
+    struct buf_pipe_buf *bufs[MAX_BATCH];
+    int count;
+
+    while ((count = buf_pipe_get_batch(&shadow, bufs, MAX_BATCH, K_NO_WAIT)) > 0)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            process(bufs[i]);
+            buf_pipe_free(&shadow, bufs[i]);
+        }
+    }
+}
+
+int ndef_rx_init(void)
+{
+    buf_pipe_init(&shadow);
+    sys_slist_init(&consumers);
+    k_work_init(&process_work, process_work_handler);
+    k_work_queue_start(&ndef_rx_q, ndef_rx_stack, K_THREAD_STACK_SIZEOF(ndef_rx_stack),
+                       CONFIG_APP_NDEF_RX_PRIORITY, NULL);
+    k_thread_name_set(&ndef_rx_q.thread, "ndef_rx");
+    return 0;
+}
+
+void ndef_rx_register(struct ndef_rx_consumer *consumer)
+{
+    sys_slist_append(&consumers, &consumer->node);
+}
+
+static void count_drop(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    stats.dropped++;
+    k_spin_unlock(&lock, key);
+}
+
+int ndef_rx_submit(const uint8_t *msg, size_t len)
+{
+    if (len > CONFIG_APP_NDEF_RX_BUF_SIZE)
+    {
+        count_drop();
+        return -E2BIG;
+    }
+
+    struct buf_pipe_buf *buf = buf_pipe_alloc(&shadow, K_NO_WAIT);
+    if (!buf)
+    {
+        count_drop();
+        return -ENOMEM;
+    }
+
+    memcpy(buf->data, msg, len);
+    buf->len = (uint16_t)len;
+    buf_pipe_put(&shadow, buf);
+    k_work_submit_to_queue(&ndef_rx_q, &process_work);
+    return 0;
+}
+
+void ndef_rx_stats_get(struct ndef_rx_stats *out)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    *out = stats;
+    k_spin_unlock(&lock, key);
+}
+
+void ndef_rx_stats_reset(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    memset(&stats, 0, sizeof(stats));
+    k_spin_unlock(&lock, key);
+}
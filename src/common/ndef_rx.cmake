@@ -0,0 +1,9 @@
+# Shared NDEF receive pipeline (ndef_rx.c). Include from a sample's
+# CMakeLists.txt after find_package(Zephyr):
+#   include(${CMAKE_CURRENT_SOURCE_DIR}/../common/ndef_rx.cmake)
+target_sources(app PRIVATE ${CMAKE_CURRENT_LIST_DIR}/ndef_rx.c)
+target_include_directories(app PRIVATE ${CMAKE_CURRENT_LIST_DIR})
+
+# Shadow buffers and the record parser
+include(${CMAKE_CURRENT_LIST_DIR}/buf_pipe.cmake)
+include(${CMAKE_CURRENT_LIST_DIR}/ndef_parse.cmake)
@@ -0,0 +1,54 @@
+#ifndef NDEF_RX_H_
+#define NDEF_RX_H_
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/slist.h>
+
+#include "ndef_parse.h"
+
+// Processing of NDEF messages written by a reader, off the NFC event
+// handler. ndef_rx_submit() copies the message out of the tag's live buffer
+// into a free shadow buffer (a buf_pipe from ../common/buf_pipe.h) and
+// returns, so the tag can take the next write right away. A dedicated
+// workqueue then walks the records and calls every consumer registered for
+// each record's TNF and type.
+//
+// Enable with CONFIG_APP_NDEF_RX, include ../common/ndef_rx.cmake and call
+// ndef_rx_init() before the first write.
+
+typedef void (*ndef_rx_handler_t)(const struct ndef_record *rec, void *user_data);
+
+struct ndef_rx_consumer
+{
+    enum ndef_tnf tnf;
+    const char *type; // record type to match, NULL for every record of the TNF
+    ndef_rx_handler_t handler;
+    void *user_data;
+
+    // Private
+    sys_snode_t node;
+};
+
+struct ndef_rx_stats
+{
+    uint32_t messages;  // parsed and dispatched
+    uint32_t records;
+    uint32_t malformed; // rejected by the parser
+    uint32_t dropped;   // no free shadow buffer, or larger than one
+    uint32_t max_process_us; // parse and dispatch of one message
+};
+
+int ndef_rx_init(void);
+
+// Consumers are called on the ndef_rx workqueue, in registration order
+void ndef_rx_register(struct ndef_rx_consumer *consumer);
+
+// Snapshot 'len' bytes of NDEF message. Safe from ISRs, never blocks.
+// Returns -ENOMEM when every shadow buffer is in use, -E2BIG when the
+// message doesn't fit one.
+int ndef_rx_submit(const uint8_t *msg, size_t len);
+
+void ndef_rx_stats_get(struct ndef_rx_stats *stats);
+void ndef_rx_stats_reset(void);
+
+#endif /* NDEF_RX_H_ */
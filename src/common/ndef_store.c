@@ -0,0 +1,235 @@
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/fs/nvs.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/sys/crc.h>
+#include <string.h>
+
+#include "ndef_store.h"
+
+// NVS can't keep an entry larger than a sector, so the message is split into
+// chunks. There are two banks of chunk IDs. A write fills the bank that isn't
+// in use, then the header switches to it, so a reset in the middle of a write
+// leaves the previous message intact.
+#define NDEF_STORE_ID_HEADER 1
+#define NDEF_STORE_ID_CHUNK 0x100 // bank 0, bank 1 starts CHUNK_STRIDE later
+#define CHUNK_SIZE 1024
+#define CHUNK_STRIDE 0x100
+#define CHUNK_COUNT DIV_ROUND_UP(CONFIG_APP_NDEF_STORE_MAX_SIZE, CHUNK_SIZE)
+
+BUILD_ASSERT(CHUNK_COUNT <= CHUNK_STRIDE, "APP_NDEF_STORE_MAX_SIZE needs too many chunks");
+
+struct store_header
+{
+    uint32_t len;
+    uint32_t crc;
+    uint32_t bank;
+};
+
+static struct nvs_fs fs;
+
+// Latest submitted message, written when the debounce time runs out. The
+// work handler copies it out first, so a write arriving during the flash
+// operation only touches 'pending'.
+static uint8_t pending[CONFIG_APP_NDEF_STORE_MAX_SIZE];
+static size_t pending_len;
+static uint8_t write_buf[CONFIG_APP_NDEF_STORE_MAX_SIZE];
+
+// CRC and bank of what's in flash, only used from the workqueue after restore
+static uint32_t stored_crc;
+static bool stored_valid;
+static uint32_t stored_bank;
+
+static struct ndef_store_stats stats;
+static struct k_spinlock lock;
+
+static void write_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(write_work, write_work_handler);
+
+static uint16_t chunk_id(uint32_t bank, size_t index)
+{
+    return NDEF_STORE_ID_CHUNK + bank * CHUNK_STRIDE + index;
+}
+
+// Chunks first, then the header that points to them. Chunks of an older,
+// longer message stay behind the new length, the header tells where it ends.
+static ssize_t write_message(const uint8_t *msg, size_t len, uint32_t crc)
+{
+    struct store_header header = {
+        .len = len,
+        .crc = crc,
+        .bank = stored_valid ? !stored_bank : 0,
+    };
+
+    for (size_t i = 0, off = 0; off < len; i++, off += CHUNK_SIZE)
+    {
+        ssize_t ret = nvs_write(&fs, chunk_id(header.bank, i), &msg[off],
+                                MIN(CHUNK_SIZE, len - off));
+        if (ret < 0)
+            return ret;
+    }
+
+    ssize_t ret = nvs_write(&fs, NDEF_STORE_ID_HEADER, &header, sizeof(header));
+    if (ret >= 0)
+        stored_bank = header.bank;
+    return ret;
+}
+
+static void write_work_handler(struct k_work *work)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    size_t len = pending_len;
+    memcpy(write_buf, pending, len);
+    pending_len = 0;
+    k_spin_unlock(&lock, key);
+
+    if (len == 0)
+        return;
+
+    uint32_t crc = crc32_ieee(write_buf, len);
+    if (stored_valid && crc == stored_crc)
+    {
+        key = k_spin_lock(&lock);
+        stats.unchanged++;
+        k_spin_unlock(&lock, key);
+        return;
+    }
+
+    uint32_t start = k_cycle_get_32();
+    ssize_t ret = write_message(write_buf, len, crc);
+    uint32_t us = k_cyc_to_us_ceil32(k_cycle_get_32() - start);
+
+    // The header changes on every write (CRC, bank), so NVS never skips it
+    key = k_spin_lock(&lock);
+    if (ret < 0)
+    {
+        stats.errors++;
+    }
+    else
+    {
+        stats.writes++;
+        stats.max_write_us = MAX(stats.max_write_us, us);
+    }
+    k_spin_unlock(&lock, key);
+
+    if (ret >= 0)
+    {
+        stored_crc = crc;
+        stored_valid = true;
+    }
+}
+
+int ndef_store_init(void)
+{
+    struct flash_pages_info info;
+    int err;
+
+    fs.flash_device = FIXED_PARTITION_DEVICE(storage_partition);
+    if (!device_is_ready(fs.flash_device))
+        return -ENODEV;
+
+    fs.offset = FIXED_PARTITION_OFFSET(storage_partition);
+    err = flash_get_page_info_by_offs(fs.flash_device, fs.offset, &info);
+    if (err)
+        return err;
+
+    // Spread the wear over the whole partition
+    fs.sector_size = info.size;
+    fs.sector_count = FIXED_PARTITION_SIZE(storage_partition) / info.size;
+
+    // A chunk must fit a sector with NVS's allocation entries, and both
+    // banks the partition, less the sector NVS keeps free for its garbage
+    // collection. Refuse here rather than fail every write later.
+    if (CHUNK_SIZE > fs.sector_size / 2 ||
+        2 * CHUNK_COUNT * CHUNK_SIZE > (fs.sector_count - 1) * fs.sector_size)
+        return -ENOSPC;
+
+    return nvs_mount(&fs);
+}
+
+static int read_message(uint8_t *buf, size_t size)
+{
+    struct store_header header;
+
+    ssize_t ret = nvs_read(&fs, NDEF_STORE_ID_HEADER, &header, sizeof(header));
+    if (ret == -ENOENT)
+        return 0;
+    if (ret < 0)
+        return ret;
+    if (ret != sizeof(header) || header.bank > 1)
+        return -EBADMSG;
+    if (header.len > size)
+        return -E2BIG;
+
+    for (size_t i = 0, off = 0; off < header.len; i++, off += CHUNK_SIZE)
+    {
+        size_t n = MIN(CHUNK_SIZE, header.len - off);
+
+        ret = nvs_read(&fs, chunk_id(header.bank, i), &buf[off], n);
+        if (ret < 0)
+            return ret;
+        if ((size_t)ret != n)
+            return -EBADMSG;
+    }
+
+    if (crc32_ieee(buf, header.len) != header.crc)
+        return -EBADMSG;
+
+    stored_crc = header.crc;
+    stored_bank = header.bank;
+    stored_valid = true;
+    return header.len;
+}
+
+int ndef_store_restore(uint8_t *buf, size_t size)
+{
+    uint32_t start = k_cycle_get_32();
+    int len = read_message(buf, size);
+
+    stats.restore_us = k_cyc_to_us_ceil32(k_cycle_get_32() - start);
+    return len;
+}
+
+int ndef_store_submit(const uint8_t *msg, size_t len)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    stats.submitted++;
+    if (len > sizeof(pending))
+    {
+        stats.errors++;
+        k_spin_unlock(&lock, key);
+        return -E2BIG;
+    }
+    if (pending_len)
+        stats.coalesced++;
+
+    memcpy(pending, msg, len);
+    pending_len = len;
+    k_spin_unlock(&lock, key);
+
+    k_work_reschedule(&write_work, K_MSEC(CONFIG_APP_NDEF_STORE_DEBOUNCE_MS));
+    return 0;
+}
+
+void ndef_store_flush(void)
+{
+    struct k_work_sync sync;
+
+    k_work_flush_delayable(&write_work, &sync);
+}
+
+void ndef_store_stats_get(struct ndef_store_stats *out)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    *out = stats;
+    k_spin_unlock(&lock, key);
+}
+
+void ndef_store_stats_reset(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    memset(&stats, 0, sizeof(stats));
+    k_spin_unlock(&lock, key);
+}
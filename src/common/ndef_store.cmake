@@ -0,0 +1,5 @@
+# Shared NDEF message persistence (ndef_store.c). Include from a sample's
+# CMakeLists.txt after find_package(Zephyr):
+#   include(${CMAKE_CURRENT_SOURCE_DIR}/../common/ndef_store.cmake)
+target_sources(app PRIVATE ${CMAKE_CURRENT_LIST_DIR}/ndef_store.c)
+target_include_directories(app PRIVATE ${CMAKE_CURRENT_LIST_DIR})
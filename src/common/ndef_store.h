@@ -0,0 +1,88 @@
+#ifndef NDEF_STORE_H_
+#define NDEF_STORE_H_
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Keeps the last NDEF message written by a reader in NVS, so it survives a
+// reboot. Writes are coalesced: ndef_store_submit() only copies the message
+// into a pending buffer and restarts a debounce timer, and when the reader
+// has been quiet for CONFIG_APP_NDEF_STORE_DEBOUNCE_MS the latest message
+// is written from the system workqueue. A message with the same CRC-32 as
+// the one already stored is not written again, so a phone rewriting the
+// same content costs no flash wear. The message is stored in 1 KB NVS
+// entries, since NVS can't keep one larger than a flash sector, and switched
+// to with a header entry written last.
+//
+// Enable with CONFIG_APP_NDEF_STORE, include ../common/ndef_store.cmake.
+// The board needs a storage_partition. Call ndef_store_init(), then
+// ndef_store_restore() before the tag starts emulation. Without the option
+// ndef_store_init() returns -ENOTSUP and the other calls do nothing.
+
+struct ndef_store_stats
+{
+    uint32_t submitted; // messages passed to ndef_store_submit()
+    uint32_t coalesced; // replaced by a newer one within the debounce time
+    uint32_t unchanged; // same CRC as the stored message, not written
+    uint32_t writes;    // messages written to flash
+    uint32_t errors;    // failed writes and messages too large to keep
+    uint32_t max_write_us;
+    uint32_t restore_us; // last ndef_store_restore()
+};
+
+#if defined(CONFIG_APP_NDEF_STORE)
+
+// Mounts NVS on storage_partition. Returns -ENOSPC if the partition can't
+// hold two copies of a CONFIG_APP_NDEF_STORE_MAX_SIZE message.
+int ndef_store_init(void);
+
+// Reads the stored message into 'buf'. Returns its length, 0 if nothing
+// has been stored yet, -E2BIG if it doesn't fit 'size', -EBADMSG if its
+// CRC doesn't match.
+int ndef_store_restore(uint8_t *buf, size_t size);
+
+// Queues 'len' bytes of NDEF message for writing. Safe from ISRs, never
+// blocks. Returns -E2BIG beyond CONFIG_APP_NDEF_STORE_MAX_SIZE.
+int ndef_store_submit(const uint8_t *msg, size_t len);
+
+// Writes a pending message now instead of at the end of the debounce time,
+// and waits for it. Call before a planned reboot.
+void ndef_store_flush(void);
+
+void ndef_store_stats_get(struct ndef_store_stats *stats);
+void ndef_store_stats_reset(void);
+
+#else
+
+static inline int ndef_store_init(void)
+{
+    return -ENOTSUP;
+}
+
+static inline int ndef_store_restore(uint8_t *buf, size_t size)
+{
+    return 0;
+}
+
+static inline int ndef_store_submit(const uint8_t *msg, size_t len)
+{
+    return 0;
+}
+
+static inline void ndef_store_flush(void)
+{
+}
+
+static inline void ndef_store_stats_get(struct ndef_store_stats *stats)
+{
+    *stats = (struct ndef_store_stats){0};
+}
+
+static inline void ndef_store_stats_reset(void)
+{
+}
+
+#endif /* CONFIG_APP_NDEF_STORE */
+
+#endif /* NDEF_STORE_H_ */
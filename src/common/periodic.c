@@ -0,0 +1,220 @@
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+
+#include "periodic.h"
+
+// Jobs hash into a slot by the latest time they may run. A slot holds jobs
+// from every rotation of the wheel, so scans compare the actual times.
+static sys_dlist_t wheel[PERIODIC_WHEEL_SLOTS];
+static int64_t cursor_slot = 0; // no pending job sits in an earlier slot
+static uint32_t max_tolerance_ms = 0;
+static struct periodic_stats stats;
+static struct k_spinlock lock;
+
+// Jobs collected at the current wakeup and not run yet. Only touched under
+// the lock, so periodic_job_stop() can take a job back out of it.
+static sys_slist_t due;
+
+// Given when jobs are added or removed, so the executor re-plans its sleep
+static K_SEM_DEFINE(replan, 0, 1);
+
+static inline int64_t latest_run(const struct periodic_job *job)
+{
+    return job->deadline + job->tolerance_ms;
+}
+
+// Caller holds the lock
+static void wheel_insert(struct periodic_job *job)
+{
+    int64_t slot = latest_run(job) / PERIODIC_SLOT_MS;
+    sys_dlist_append(&wheel[slot % PERIODIC_WHEEL_SLOTS], &job->node);
+}
+
+// Caller holds the lock. Earliest time any job must run by, INT64_MAX if none.
+static int64_t next_wakeup(void)
+{
+    struct periodic_job *job;
+    int64_t best = INT64_MAX;
+
+    // Walk one rotation from the cursor. The first slot with a job from this
+    // rotation (or an overdue one) holds the answer.
+    for (int64_t slot = cursor_slot; slot < cursor_slot + PERIODIC_WHEEL_SLOTS; slot++)
+    {
+        SYS_DLIST_FOR_EACH_CONTAINER(&wheel[slot % PERIODIC_WHEEL_SLOTS], job, node)
+        {
+            if (latest_run(job) / PERIODIC_SLOT_MS <= slot)
+                best = MIN(best, latest_run(job));
+        }
+        if (best != INT64_MAX)
+            return best;
+    }
+
+    // Everything is at least one rotation away
+    for (int i = 0; i < PERIODIC_WHEEL_SLOTS; i++)
+    {
+        SYS_DLIST_FOR_EACH_CONTAINER(&wheel[i], job, node)
+        {
+            best = MIN(best, latest_run(job));
+        }
+    }
+    return best;
+}
+
+// Moves every job released by 'now' to 'due' and schedules its next release.
+// Caller holds the lock.
+static void collect_due(int64_t now)
+{
+    // A due job may run up to max_tolerance_ms late, so it can sit in any
+    // slot up to there
+    int64_t first = cursor_slot;
+    int64_t last = (now + max_tolerance_ms) / PERIODIC_SLOT_MS;
+    if (last - first >= PERIODIC_WHEEL_SLOTS)
+        first = last - PERIODIC_WHEEL_SLOTS + 1;
+
+    for (int64_t slot = first; slot <= last; slot++)
+    {
+        struct periodic_job *job;
+        struct periodic_job *tmp;
+
+        SYS_DLIST_FOR_EACH_CONTAINER_SAFE(&wheel[slot % PERIODIC_WHEEL_SLOTS], job, tmp, node)
+        {
+            if (job->deadline > now)
+                continue;
+
+            uint32_t late = now - job->deadline;
+            stats.max_late_ms = MAX(stats.max_late_ms, late);
+            stats.runs++;
+
+            // Keep the release times on the period grid, skipping any that
+            // were missed entirely
+            job->deadline += job->period_ms * (late / job->period_ms + 1);
+
+            sys_dlist_remove(&job->node);
+            wheel_insert(job);
+            if (!job->queued)
+            {
+                sys_slist_append(&due, &job->ready);
+                job->queued = true;
+            }
+        }
+    }
+
+    cursor_slot = now / PERIODIC_SLOT_MS;
+}
+
+static void executor(void *p1, void *p2, void *p3)
+{
+    while (1)
+    {
+        k_spinlock_key_t key = k_spin_lock(&lock);
+        int64_t wake = next_wakeup();
+        k_spin_unlock(&lock, key);
+
+        int64_t now = k_uptime_get();
+        if (wake > now)
+        {
+            k_timeout_t timeout = wake == INT64_MAX ? K_FOREVER : K_MSEC(wake - now);
+            if (k_sem_take(&replan, timeout) == 0)
+                continue;
+        }
+
+        key = k_spin_lock(&lock);
+        stats.wakeups++;
+        collect_due(k_uptime_get());
+        k_spin_unlock(&lock, key);
+
+        // One job at a time off the list, under the lock, and the function
+        // copied before it is called: once a job is off the list, stopping
+        // or re-initializing it can't affect this loop.
+        while (1)
+        {
+            key = k_spin_lock(&lock);
+            sys_snode_t *node = sys_slist_get(&due);
+            if (!node)
+            {
+                k_spin_unlock(&lock, key);
+                break;
+            }
+
+            struct periodic_job *job = CONTAINER_OF(node, struct periodic_job, ready);
+            periodic_fn_t fn = job->fn;
+            job->queued = false;
+            job->runs++;
+            k_spin_unlock(&lock, key);
+
+            fn(job);
+        }
+    }
+}
+
+K_THREAD_DEFINE(periodic_thread, PERIODIC_STACK_SIZE, executor, NULL, NULL, NULL,
+                PERIODIC_PRIORITY, 0, 0);
+
+void periodic_job_init(struct periodic_job *job, periodic_fn_t fn, uint32_t period_ms,
+                       uint32_t tolerance_ms)
+{
+    *job = (struct periodic_job){
+        .fn = fn,
+        .period_ms = MAX(period_ms, 1),
+        .tolerance_ms = tolerance_ms,
+    };
+    sys_dnode_init(&job->node);
+}
+
+void periodic_job_start(struct periodic_job *job, uint32_t delay_ms)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    if (sys_dnode_is_linked(&job->node))
+        sys_dlist_remove(&job->node);
+
+    job->deadline = k_uptime_get() + delay_ms;
+    job->active = true;
+    max_tolerance_ms = MAX(max_tolerance_ms, job->tolerance_ms);
+    wheel_insert(job);
+    k_spin_unlock(&lock, key);
+
+    k_sem_give(&replan);
+}
+
+void periodic_job_stop(struct periodic_job *job)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    if (sys_dnode_is_linked(&job->node))
+        sys_dlist_remove(&job->node);
+    if (job->queued)
+    {
+        // Collected at this wakeup but not run yet
+        sys_slist_find_and_remove(&due, &job->ready);
+        job->queued = false;
+    }
+    job->active = false;
+    k_spin_unlock(&lock, key);
+
+    k_sem_give(&replan);
+}
+
+void periodic_stats_get(struct periodic_stats *out)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    *out = stats;
+    k_spin_unlock(&lock, key);
+}
+
+void periodic_stats_reset(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    stats = (struct periodic_stats){0};
+    k_spin_unlock(&lock, key);
+}
+
+static int periodic_init(void)
+{
+    for (int i = 0; i < PERIODIC_WHEEL_SLOTS; i++)
+        sys_dlist_init(&wheel[i]);
+    sys_slist_init(&due);
+
+    return 0;
+}
+
+// Before main(), so jobs can be started from there
+SYS_INIT(periodic_init, APPLICATION, 0);
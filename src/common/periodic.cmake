@@ -0,0 +1,5 @@
+# Shared periodic job executor (periodic.c). Include from a sample's CMakeLists.txt
+# after find_package(Zephyr):
+#   include(${CMAKE_CURRENT_SOURCE_DIR}/../common/periodic.cmake)
+target_sources(app PRIVATE ${CMAKE_CURRENT_LIST_DIR}/periodic.c)
+target_include_directories(app PRIVATE ${CMAKE_CURRENT_LIST_DIR})
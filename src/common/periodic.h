@@ -0,0 +1,67 @@
+#ifndef PERIODIC_H_
+#define PERIODIC_H_
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/dlist.h>
+#include <zephyr/sys/slist.h>
+
+// Runs many periodic jobs on one thread instead of one thread (and one
+// stack) per job. Jobs sit in a timer wheel keyed by the latest time they
+// may run. Every job also states how late it may run (its tolerance). The
+// executor sleeps until the earliest of those latest times, and then runs
+// every job that is due, so jobs whose windows overlap share one wakeup.
+// Include ../common/periodic.cmake from the app.
+
+#ifndef PERIODIC_STACK_SIZE
+#define PERIODIC_STACK_SIZE 1024
+#endif
+
+#ifndef PERIODIC_PRIORITY
+#define PERIODIC_PRIORITY 5
+#endif
+
+#define PERIODIC_WHEEL_SLOTS 32
+#define PERIODIC_SLOT_MS 10
+
+struct periodic_job;
+typedef void (*periodic_fn_t)(struct periodic_job *job);
+
+struct periodic_job
+{
+    periodic_fn_t fn;
+    uint32_t period_ms;
+    uint32_t tolerance_ms; // may run up to this late to share a wakeup
+    uint32_t runs;
+
+    // Private
+    sys_dnode_t node;   // wheel slot
+    sys_snode_t ready;  // due list of the current wakeup
+    int64_t deadline;   // next release, ms since boot
+    bool active;
+    bool queued;        // on the due list
+};
+
+struct periodic_stats
+{
+    uint32_t wakeups;
+    uint32_t runs;
+    uint32_t max_late_ms; // worst release-to-run time
+};
+
+// fn receives the job, use CONTAINER_OF() to get to the surrounding struct.
+// Only for a job that was never started, or has been stopped: the executor
+// links a started job into its lists, and init overwrites the links.
+void periodic_job_init(struct periodic_job *job, periodic_fn_t fn, uint32_t period_ms,
+                       uint32_t tolerance_ms);
+
+// First run after 'delay_ms', then every period_ms
+void periodic_job_start(struct periodic_job *job, uint32_t delay_ms);
+
+// Once this returns, the job is no longer linked anywhere and won't be run
+// again, except for a run already in progress on the executor thread
+void periodic_job_stop(struct periodic_job *job);
+
+void periodic_stats_get(struct periodic_stats *stats);
+void periodic_stats_reset(void);
+
+#endif /* PERIODIC_H_ */
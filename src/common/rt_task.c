@@ -0,0 +1,83 @@
+#include <zephyr/kernel.h>
+#include <string.h>
+
+#include "rt_task.h"
+
+static inline uint32_t ticks_to_us(int64_t ticks)
+{
+    return (uint32_t)k_ticks_to_us_floor64(MAX(ticks, 0));
+}
+
+// Tell the scheduler when the job released at 'release' has to be done.
+// Called before sleeping, so the deadline is already in place when the
+// thread becomes ready and competes with the others.
+static void set_deadline(struct rt_task *task, int64_t release, int64_t period)
+{
+#if defined(CONFIG_SCHED_DEADLINE)
+    if (task->policy == RT_POLICY_EDF)
+    {
+        int64_t left = release + period - k_uptime_ticks();
+        k_thread_deadline_set(k_current_get(), (int)k_ticks_to_cyc_floor64(MAX(left, 0)));
+    }
+#endif
+}
+
+static void task_entry(void *p1, void *p2, void *p3)
+{
+    struct rt_task *task = p1;
+    struct rt_task_stats *s = &task->stats;
+    int64_t period = k_us_to_ticks_ceil64(task->period_us);
+    int64_t release = task->first_release;
+
+    while (!task->stop)
+    {
+        set_deadline(task, release, period);
+        k_sleep(K_TIMEOUT_ABS_TICKS(release));
+
+        int64_t start = k_uptime_ticks();
+        task->job(task);
+        int64_t end = k_uptime_ticks();
+
+        uint32_t jitter_us = ticks_to_us(start - release);
+        uint32_t response_us = ticks_to_us(end - release);
+
+        s->releases++;
+        s->total_jitter_us += jitter_us;
+        s->max_jitter_us = MAX(s->max_jitter_us, jitter_us);
+        s->max_response_us = MAX(s->max_response_us, response_us);
+        if (end > release + period)
+            s->misses++;
+
+        // An overrun longer than a whole period loses those releases
+        release += period;
+        while (release + period <= end)
+        {
+            release += period;
+            s->releases++;
+            s->misses++;
+        }
+    }
+}
+
+int rt_task_start(struct rt_task *task, k_thread_stack_t *stack, size_t stack_size, int prio,
+                  enum rt_policy policy, int64_t first_release_ticks)
+{
+    if (policy == RT_POLICY_EDF && !IS_ENABLED(CONFIG_SCHED_DEADLINE))
+        return -ENOTSUP;
+
+    memset(&task->stats, 0, sizeof(task->stats));
+    task->policy = policy;
+    task->first_release = first_release_ticks;
+    task->stop = false;
+
+    k_tid_t tid = k_thread_create(&task->thread, stack, stack_size, task_entry, task, NULL, NULL,
+                                  prio, 0, K_NO_WAIT);
+    k_thread_name_set(tid, task->name);
+    return 0;
+}
+
+void rt_task_stop(struct rt_task *task)
+{
+    task->stop = true;
+    k_thread_join(&task->thread, K_FOREVER);
+}
@@ -0,0 +1,5 @@
+# Shared periodic task framework (rt_task.c). Include from a sample's CMakeLists.txt
+# after find_package(Zephyr):
+#   include(${CMAKE_CURRENT_SOURCE_DIR}/../common/rt_task.cmake)
+target_sources(app PRIVATE ${CMAKE_CURRENT_LIST_DIR}/rt_task.c)
+target_include_directories(app PRIVATE ${CMAKE_CURRENT_LIST_DIR})
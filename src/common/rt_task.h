@@ -0,0 +1,57 @@
+#ifndef RT_TASK_H_
+#define RT_TASK_H_
+
+#include <zephyr/kernel.h>
+
+// Periodic tasks with release jitter and deadline miss accounting. Each task
+// is a thread that sleeps until its next absolute release time, runs its job
+// and checks the job finished before the next release (implicit deadline).
+//
+// With RT_POLICY_EDF the task also hands its deadline to the scheduler
+// (CONFIG_SCHED_DEADLINE), which then runs the ready task with the earliest
+// deadline first. Zephyr only compares deadlines between threads of the
+// same priority, so start every EDF task with the same one.
+// Include ../common/rt_task.cmake from the app.
+
+enum rt_policy
+{
+    RT_POLICY_STATIC, // plain static priority, whatever the caller passes
+    RT_POLICY_EDF,    // earliest deadline first among equal priorities
+};
+
+struct rt_task;
+typedef void (*rt_job_t)(struct rt_task *task);
+
+struct rt_task_stats
+{
+    uint32_t releases;
+    uint32_t misses;          // finished after the next release, or skipped
+    uint32_t max_jitter_us;   // release to start of the job
+    uint64_t total_jitter_us;
+    uint32_t max_response_us; // release to end of the job
+};
+
+struct rt_task
+{
+    const char *name;
+    uint32_t period_us;
+    rt_job_t job;
+    struct rt_task_stats stats;
+
+    // Private
+    struct k_thread thread;
+    enum rt_policy policy;
+    int64_t first_release; // ticks
+    volatile bool stop;
+};
+
+// Starts the task thread. The first release is at 'first_release_ticks'
+// (k_uptime_ticks() time base), give every task of a set the same one to
+// release them together.
+int rt_task_start(struct rt_task *task, k_thread_stack_t *stack, size_t stack_size, int prio,
+                  enum rt_policy policy, int64_t first_release_ticks);
+
+// Stops the task after its current period and waits for its thread to exit
+void rt_task_stop(struct rt_task *task);
+
+#endif /* RT_TASK_H_ */
@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""Decode dictionary logs and compare logging profiles of two builds.
+
+Build the same sample twice, once as is and once with the deferred
+dictionary profile, both with the callback timing enabled:
+
+    west build -d build-imm -b nrf52840dk/nrf52840 -- \\
+        -DEXTRA_CONF_FILE=../common/cb_timing.conf
+    west build -d build-dict -b nrf52840dk/nrf52840 -- \\
+        -DEXTRA_CONF_FILE="../common/log_dict.conf;../common/cb_timing.conf"
+
+Run the same scenario (connect, disconnect) on each and capture the console.
+The dictionary build prints hex records, decode them with the build's
+database (this runs Zephyr's scripts/logging/dictionary/log_parser.py):
+
+    python3 ../common/scripts/log_profile.py decode build-dict dict.log > dict.txt
+
+Then compare flash usage and the callback times printed by cb_timing.c:
+
+    python3 ../common/scripts/log_profile.py compare build-imm build-dict \\
+        --base-log imm.log --new-log dict.txt
+"""
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+
+TIMING_LINE = re.compile(r'\{"callback":.*\}')
+
+
+def elf_of(build):
+    return os.path.join(build, "zephyr", "zephyr.elf")
+
+
+def decode(args):
+    zephyr_base = os.environ.get("ZEPHYR_BASE")
+    if not zephyr_base:
+        sys.exit("ZEPHYR_BASE is not set, run from a west workspace")
+
+    db = os.path.join(args.build, "zephyr", "log_dictionary.json")
+    if not os.path.exists(db):
+        sys.exit("%s not found, was the build made with log_dict.conf?" % db)
+
+    parser = os.path.join(zephyr_base, "scripts", "logging", "dictionary", "log_parser.py")
+    sys.exit(subprocess.call([sys.executable, parser, "--hex", db, args.log]))
+
+
+def sizes(build, size_tool):
+    """text, data and bss of a build, Berkeley format"""
+    out = subprocess.run([size_tool, elf_of(build)], check=True, capture_output=True,
+                         text=True).stdout
+    text, data, bss = (int(v) for v in out.splitlines()[1].split()[:3])
+    return {"flash": text + data, "ram": data + bss}
+
+
+def timings(log):
+    """Last cb_timing line of every callback in a log"""
+    result = {}
+    if not log:
+        return result
+    with open(log, errors="replace") as f:
+        for line in f:
+            match = TIMING_LINE.search(line)
+            if match:
+                entry = json.loads(match.group(0))
+                result[entry["callback"]] = entry
+    return result
+
+
+def compare(args):
+    base, new = sizes(args.base, args.size), sizes(args.new, args.size)
+    base_cb, new_cb = timings(args.base_log), timings(args.new_log)
+
+    callbacks = []
+    for name in sorted(set(base_cb) | set(new_cb)):
+        b, n = base_cb.get(name, {}), new_cb.get(name, {})
+        callbacks.append({
+            "callback": name,
+            "base_avg_us": b.get("avg_us"), "new_avg_us": n.get("avg_us"),
+            "base_max_us": b.get("max_us"), "new_max_us": n.get("max_us"),
+        })
+
+    report = {
+        "base": args.base, "new": args.new,
+        "flash_saved": base["flash"] - new["flash"],
+        "ram_saved": base["ram"] - new["ram"],
+        "callbacks": callbacks,
+    }
+
+    if args.json:
+        json.dump(report, sys.stdout, indent=2)
+        print()
+        return
+
+    print("%-12s %10s %10s %10s" % ("", args.base[-10:], args.new[-10:], "saved"))
+    for key in ("flash", "ram"):
+        print("%-12s %10d %10d %10d" % (key, base[key], new[key], base[key] - new[key]))
+
+    def us(v):
+        return "-" if v is None else str(v)
+
+    if callbacks:
+        print()
+        print("%-20s %9s %9s %9s %9s" % ("callback (us)", "base avg", "new avg", "base max",
+                                         "new max"))
+        for row in callbacks:
+            print("%-20s %9s %9s %9s %9s" % (row["callback"][:20], us(row["base_avg_us"]),
+                                             us(row["new_avg_us"]), us(row["base_max_us"]),
+                                             us(row["new_max_us"])))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    p = sub.add_parser("decode", help="decode a hex dictionary log")
+    p.add_argument("build", help="build directory of the dictionary build")
+    p.add_argument("log", help="captured console output")
+    p.set_defaults(func=decode)
+
+    p = sub.add_parser("compare", help="compare flash/RAM and callback times of two builds")
+    p.add_argument("base", help="build directory of the current configuration")
+    p.add_argument("new", help="build directory of the profile to compare")
+    p.add_argument("--base-log", help="console output of the base build")
+    p.add_argument("--new-log", help="console output of the new build, decoded")
+    p.add_argument("--size", default="arm-zephyr-eabi-size", help="size tool of the toolchain")
+    p.add_argument("--json", action="store_true", help="print the report as JSON")
+    p.set_defaults(func=compare)
+
+    args = parser.parse_args()
+    args.func(args)
+
+
+if __name__ == "__main__":
+    main()
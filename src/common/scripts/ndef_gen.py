@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+"""Encode an NDEF message from a declarative record list at build time.
+
+The record list is a JSON array, one object per record:
+
+    [
+      {"type": "text", "lang": "en", "text": "Hello World!"},
+      {"type": "uri", "uri": "https://www.nordicsemi.com"},
+      {"type": "mime", "mime": "application/json", "data": "{\\"v\\": 1}"},
+      {"type": "mime", "mime": "application/octet-stream", "hex": "0102ff"}
+    ]
+
+The output is the raw NDEF message. It holds the same records as
+nfc_ndef_msg_encode() at runtime, but it is not the same bytes: this writes
+short records below 256 payload bytes, where NCS always writes long ones,
+so readers see an equivalent message, 3 bytes shorter per record. URI
+prefixes are abbreviated. nfc-01's CMakeLists.txt runs this and turns the result into a
+const array with generate_inc_file_for_target():
+
+    python3 ndef_gen.py ndef.json ndef_msg.bin --max-size 988
+"""
+
+import argparse
+import json
+import sys
+
+TNF_WELL_KNOWN = 0x01
+TNF_MIME = 0x02
+
+FLAG_MB = 0x80
+FLAG_ME = 0x40
+FLAG_SR = 0x10
+
+# NFC Forum URI Record Type Definition, identifier codes 0x01-0x23
+URI_PREFIXES = [
+    "", "http://www.", "https://www.", "http://", "https://", "tel:", "mailto:",
+    "ftp://anonymous:anonymous@", "ftp://ftp.", "ftps://", "sftp://", "smb://", "nfs://",
+    "ftp://", "dav://", "news:", "telnet://", "imap:", "rtsp://", "urn:", "pop:", "sip:",
+    "sips:", "tftp:", "btspp://", "btl2cap://", "btgoep://", "tcpobex://", "irdaobex://",
+    "file://", "urn:epc:id:", "urn:epc:tag:", "urn:epc:pat:", "urn:epc:raw:", "urn:epc:",
+    "urn:nfc:",
+]
+
+
+def text_record(rec):
+    lang = rec.get("lang", "en").encode("ascii")
+    if len(lang) > 0x3F:
+        raise ValueError("language code too long: %r" % lang)
+    # Status byte: bit 7 clear for UTF-8, low bits the language code length
+    return TNF_WELL_KNOWN, b"T", bytes([len(lang)]) + lang + rec["text"].encode("utf-8")
+
+
+def uri_record(rec):
+    uri = rec["uri"]
+    code = max(range(len(URI_PREFIXES)),
+               key=lambda i: len(URI_PREFIXES[i]) if uri.startswith(URI_PREFIXES[i]) else -1)
+    return TNF_WELL_KNOWN, b"U", bytes([code]) + uri[len(URI_PREFIXES[code]):].encode("utf-8")
+
+
+def mime_record(rec):
+    if "hex" in rec:
+        data = bytes.fromhex(rec["hex"])
+    else:
+        data = rec.get("data", "").encode("utf-8")
+    return TNF_MIME, rec["mime"].encode("ascii"), data
+
+
+ENCODERS = {"text": text_record, "uri": uri_record, "mime": mime_record}
+
+
+def encode_record(tnf, rtype, payload, first, last):
+    header = tnf
+    if first:
+        header |= FLAG_MB
+    if last:
+        header |= FLAG_ME
+
+    if len(payload) < 256:
+        header |= FLAG_SR
+        length = bytes([len(payload)])
+    else:
+        length = len(payload).to_bytes(4, "big")
+
+    return bytes([header, len(rtype)]) + length + rtype + payload
+
+
+def encode_message(records):
+    if not records:
+        raise ValueError("the record list is empty")
+
+    out = bytearray()
+    for i, rec in enumerate(records):
+        kind = rec.get("type")
+        if kind not in ENCODERS:
+            raise ValueError("record %d: unknown type %r, expected one of %s"
+                             % (i, kind, ", ".join(ENCODERS)))
+        tnf, rtype, payload = ENCODERS[kind](rec)
+        out += encode_record(tnf, rtype, payload, i == 0, i == len(records) - 1)
+    return bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("records", help="JSON record list")
+    parser.add_argument("out", help="binary NDEF message to write")
+    parser.add_argument("--max-size", type=int, default=0,
+                        help="fail if the message is larger (bytes, 0 for no limit)")
+    args = parser.parse_args()
+
+    with open(args.records) as f:
+        records = json.load(f)
+
+    try:
+        msg = encode_message(records)
+    except (KeyError, ValueError) as e:
+        sys.exit("%s: %s" % (args.records, e))
+
+    if args.max_size and len(msg) > args.max_size:
+        sys.exit("%s: NDEF message is %d bytes, the tag holds %d"
+                 % (args.records, len(msg), args.max_size))
+
+    with open(args.out, "wb") as f:
+        f.write(msg)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""Generate a right-sized stack overlay from a CONFIG_APP_STACK_REPORT log.
+
+Build a sample with the instrumented configuration, run its scenario (connect,
+pair, write characteristics, ...) while capturing the console, then:
+
+    west build -b nrf52840dk/nrf52840 -- -DEXTRA_CONF_FILE=../common/stack_report.conf
+    python3 ../common/scripts/stack_overlay.py --log console.log --sample ble-04 \\
+        --out stack-overlay.conf
+
+The peak of every 'stack: "<name>" used=<n> size=<n>' line is taken, the
+margin is added, and threads whose stack size comes from a known Kconfig
+option get an entry in the overlay. Apply it with
+-DEXTRA_CONF_FILE=stack-overlay.conf. Use --port instead of --log to capture
+straight from a serial port.
+"""
+
+import argparse
+import json
+import re
+import sys
+import time
+
+STACK_LINE = re.compile(r'stack: "(?P<name>[^"]*)" used=(?P<used>\d+) size=(?P<size>\d+)')
+
+# Thread name -> Kconfig option that sizes its stack
+KCONFIG = {
+    "main": "CONFIG_MAIN_STACK_SIZE",
+    "sysworkq": "CONFIG_SYSTEM_WORKQUEUE_STACK_SIZE",
+    "isr0": "CONFIG_ISR_STACK_SIZE",
+    "idle": "CONFIG_IDLE_STACK_SIZE",
+    "logging": "CONFIG_LOG_PROCESS_THREAD_STACK_SIZE",
+    "BT RX WQ": "CONFIG_BT_RX_STACK_SIZE",
+    "BT RX": "CONFIG_BT_RX_STACK_SIZE",
+    "BT LW WQ": "CONFIG_BT_LONG_WQ_STACK_SIZE",
+    "BT HCI TX": "CONFIG_BT_HCI_TX_STACK_SIZE",
+    "BT CTLR ECDH": "CONFIG_BT_CTLR_ECDH_STACK_SIZE",
+    "MPSL Work": "CONFIG_MPSL_WORK_STACK_SIZE",
+    "shell_uart": "CONFIG_SHELL_STACK_SIZE",
+}
+
+STACK_ALIGN = 64
+
+
+def read_lines(args):
+    if args.log:
+        with open(args.log, errors="replace") as f:
+            yield from f
+        return
+
+    import serial
+
+    with serial.Serial(args.port, args.baud, timeout=0.5) as ser:
+        end = time.monotonic() + args.duration
+        while time.monotonic() < end:
+            line = ser.readline().decode(errors="replace")
+            if line:
+                sys.stderr.write(line)
+                yield line
+
+
+def collect(lines):
+    peaks = {}
+    for line in lines:
+        match = STACK_LINE.search(line)
+        if not match:
+            continue
+        name = match["name"]
+        used, size = int(match["used"]), int(match["size"])
+        peak = peaks.setdefault(name, {"used": 0, "size": size, "reports": 0})
+        peak["used"] = max(peak["used"], used)
+        peak["size"] = size
+        peak["reports"] += 1
+    return peaks
+
+
+def right_size(used, margin_pct, margin_min):
+    size = used + max(used * margin_pct // 100, margin_min)
+    return (size + STACK_ALIGN - 1) // STACK_ALIGN * STACK_ALIGN
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--log", help="captured console output")
+    source.add_argument("--port", help="serial port to capture from")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--duration", type=float, default=60.0, help="capture time with --port (s)")
+    parser.add_argument("--sample", default="", help="sample name for the report")
+    parser.add_argument("--margin-pct", type=int, default=25, help="margin on top of the peak (%%)")
+    parser.add_argument("--margin-min", type=int, default=256, help="minimum margin (bytes)")
+    parser.add_argument("--out", default="stack-overlay.conf", help="overlay to write")
+    parser.add_argument("--json", action="store_true", help="print the report as JSON")
+    args = parser.parse_args()
+
+    peaks = collect(read_lines(args))
+    if not peaks:
+        sys.exit("no 'stack:' lines found, was CONFIG_APP_STACK_REPORT enabled?")
+
+    rows = []
+    options = {}
+    for name, peak in sorted(peaks.items()):
+        option = KCONFIG.get(name)
+        new_size = right_size(peak["used"], args.margin_pct, args.margin_min)
+        row = {
+            "thread": name,
+            "used": peak["used"],
+            "size": peak["size"],
+            "new_size": new_size if option else None,
+            "option": option,
+            "saved": peak["size"] - new_size if option else 0,
+        }
+        # Several threads may share an option, the largest need wins
+        if option and options.get(option, {}).get("new_size", 0) < new_size:
+            options[option] = row
+        rows.append(row)
+
+    saved = sum(row["saved"] for row in options.values())
+
+    with open(args.out, "w") as f:
+        f.write("# Generated by stack_overlay.py%s: measured peak + max(%d%%, %d B)\n"
+                % (" for " + args.sample if args.sample else "", args.margin_pct, args.margin_min))
+        for option, row in sorted(options.items()):
+            f.write("# %s: peak %d of %d bytes\n" % (row["thread"], row["used"], row["size"]))
+            f.write("%s=%d\n" % (option, row["new_size"]))
+
+    if args.json:
+        json.dump({"sample": args.sample, "threads": rows, "ram_saved": saved}, sys.stdout, indent=2)
+        print()
+        return
+
+    print("%-16s %7s %7s %8s  %s" % ("thread", "peak", "size", "new", "option"))
+    for row in rows:
+        print("%-16s %7d %7d %8s  %s" % (row["thread"][:16], row["used"], row["size"],
+                                          row["new_size"] if row["option"] else "-",
+                                          row["option"] or "(no Kconfig option known)"))
+    print("%s: %d bytes of RAM saved, overlay written to %s"
+          % (args.sample or "sample", saved, args.out))
+
+
+if __name__ == "__main__":
+    main()
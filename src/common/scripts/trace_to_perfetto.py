@@ -0,0 +1,219 @@
+#!/usr/bin/env python3
+"""Convert a CONFIG_APP_TRACE ring dump into a Chrome/Perfetto trace.
+
+Build a sample with the trace enabled and capture the console until the
+'trace: end' line (trace_dump(), or CONFIG_APP_TRACE_DUMP_MS), then:
+
+    west build -b nrf52840dk/nrf52840 -- -DEXTRA_CONF_FILE=../common/trace.conf
+    python3 ../common/scripts/trace_to_perfetto.py --log console.log \\
+        --elf build/zephyr/zephyr.elf --out trace.json
+
+On native_sim the ring can be read straight out of memory instead, without
+printing it, e.g. from gdb on build/zephyr/zephyr.exe:
+
+    (gdb) dump binary value ring.bin trace_ring
+    python3 ../common/scripts/trace_to_perfetto.py --bin ring.bin \\
+        --elf build/zephyr/zephyr.exe --out trace.json
+
+Open trace.json in https://ui.perfetto.dev or chrome://tracing. Each CPU is
+a process with one track per thread and one for ISRs, mutex waits and holds
+are async slices, TRACE_MARK() markers are instant events. --elf resolves
+thread and mutex addresses to their symbol names with nm.
+"""
+
+import argparse
+import json
+import re
+import struct
+import subprocess
+import sys
+
+MAGIC = 0x54524331
+HEADER = struct.Struct("<IIII")  # struct trace_header
+EVENT = struct.Struct("<IIBBh")  # struct trace_event
+
+THREAD_SWITCH, ISR_ENTER, ISR_EXIT, MUTEX_LOCK, MUTEX_LOCKED, MUTEX_UNLOCK, USER_MARK = range(1, 8)
+
+BEGIN_LINE = re.compile(r"trace: begin magic (?P<magic>[0-9a-f]+) cycles_per_sec (?P<cps>\d+) "
+                        r"capacity (?P<capacity>\d+) head (?P<head>\d+) count (?P<count>\d+)")
+THREAD_LINE = re.compile(r"trace: thread (?P<addr>[0-9a-f]+) (?P<name>.*)$")
+DATA_LINE = re.compile(r"trace: data (?P<hex>[0-9a-f]+)")
+
+ISR_TID = 0
+
+
+def unpack_events(data):
+    return [EVENT.unpack_from(data, off) for off in range(0, len(data) - EVENT.size + 1, EVENT.size)]
+
+
+def read_log(path):
+    """Events, cycles/s and thread names of the last complete dump in a log"""
+    dump = None
+    current = None
+    with open(path, errors="replace") as f:
+        for line in f:
+            line = line.rstrip()
+            match = BEGIN_LINE.search(line)
+            if match:
+                current = {"cps": int(match["cps"]), "threads": {}, "data": bytearray()}
+                continue
+            if current is None:
+                continue
+            match = THREAD_LINE.search(line)
+            if match:
+                current["threads"][int(match["addr"], 16)] = match["name"]
+                continue
+            match = DATA_LINE.search(line)
+            if match:
+                current["data"] += bytes.fromhex(match["hex"])
+                continue
+            if "trace: end" in line:
+                dump, current = current, None
+
+    if dump is None:
+        sys.exit("no complete 'trace: begin' ... 'trace: end' dump found")
+    return unpack_events(dump["data"]), dump["cps"], dump["threads"]
+
+
+def read_bin(path):
+    """Events and cycles/s from a raw memory dump of trace_ring"""
+    with open(path, "rb") as f:
+        data = f.read()
+    magic, cps, capacity, head = HEADER.unpack_from(data)
+    if magic != MAGIC:
+        sys.exit("%s: bad magic %08x, not a dump of trace_ring?" % (path, magic))
+
+    ring = unpack_events(data[HEADER.size:HEADER.size + capacity * EVENT.size])
+    if head <= capacity:
+        return ring[:head], cps, {}
+    first = head % capacity
+    return ring[first:] + ring[:first], cps, {}
+
+
+def elf_symbols(elf, nm):
+    """Address -> name of the data objects in the image"""
+    out = subprocess.run([nm, "--defined-only", elf], check=True, capture_output=True,
+                         text=True).stdout
+    symbols = {}
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) != 3 or parts[1] not in "bBdD":
+            continue
+        # K_THREAD_DEFINE(name, ...) creates _k_thread_obj_name
+        name = parts[2].replace("_k_thread_obj_", "")
+        symbols.setdefault(int(parts[0], 16) & 0xFFFFFFFF, name)
+    return symbols
+
+
+def to_us(events, cps):
+    """Timestamps in us from the first event, undoing 32-bit counter wraps"""
+    times = []
+    t = 0
+    prev = events[0][0] if events else 0
+    for ev in events:
+        delta = (ev[0] - prev) & 0xFFFFFFFF
+        if delta >= 0x80000000:
+            delta -= 0x100000000  # another CPU stamped slightly earlier
+        t += delta
+        prev = ev[0]
+        times.append(t * 1e6 / cps)
+    return times
+
+
+def convert(events, cps, threads, symbols):
+    def name_of(addr):
+        return threads.get(addr) or symbols.get(addr) or "0x%08x" % addr
+
+    out = []
+    running = {}    # cpu -> (thread, start)
+    isr_stack = {}  # cpu -> [start, ...]
+    waits = {}      # (mutex, thread) -> start
+    holds = {}      # (mutex, thread) -> depth
+    seen = set()
+
+    def thread_track(cpu, thread):
+        if (cpu, thread) not in seen:
+            seen.add((cpu, thread))
+            out.append({"ph": "M", "name": "thread_name", "pid": cpu, "tid": thread,
+                        "args": {"name": name_of(thread)}})
+        return thread
+
+    def current(cpu):
+        return running.get(cpu, (0, 0))[0]
+
+    def async_event(ph, name, mutex, thread, ts, cpu):
+        out.append({"ph": ph, "cat": "mutex", "name": name, "id": "0x%08x" % mutex,
+                    "pid": cpu, "tid": thread_track(cpu, thread), "ts": ts})
+
+    times = to_us(events, cps)
+    for (_, arg, etype, cpu, extra), ts in zip(events, times):
+        thread = current(cpu)
+        if etype == THREAD_SWITCH:
+            if cpu in running:
+                prev, start = running[cpu]
+                out.append({"ph": "X", "name": name_of(prev), "pid": cpu,
+                            "tid": thread_track(cpu, prev), "ts": start, "dur": ts - start})
+            running[cpu] = (arg, ts)
+        elif etype == ISR_ENTER:
+            isr_stack.setdefault(cpu, []).append(ts)
+        elif etype == ISR_EXIT:
+            if isr_stack.get(cpu):
+                start = isr_stack[cpu].pop()
+                out.append({"ph": "X", "name": "ISR", "pid": cpu, "tid": ISR_TID, "ts": start,
+                            "dur": ts - start})
+        elif etype == MUTEX_LOCK:
+            waits[(arg, thread)] = ts
+        elif etype == MUTEX_LOCKED:
+            start = waits.pop((arg, thread), None)
+            if start is not None and ts > start:
+                async_event("b", "wait " + name_of(arg), arg, thread, start, cpu)
+                async_event("e", "wait " + name_of(arg), arg, thread, ts, cpu)
+            if extra == 0:
+                depth = holds.get((arg, thread), 0)
+                if depth == 0:
+                    async_event("b", "hold " + name_of(arg), arg, thread, ts, cpu)
+                holds[(arg, thread)] = depth + 1
+        elif etype == MUTEX_UNLOCK:
+            depth = holds.get((arg, thread), 0)
+            if depth == 1:
+                async_event("e", "hold " + name_of(arg), arg, thread, ts, cpu)
+            holds[(arg, thread)] = max(depth - 1, 0)
+        elif etype == USER_MARK:
+            out.append({"ph": "i", "s": "t", "name": "mark %d" % extra, "pid": cpu,
+                        "tid": thread_track(cpu, thread), "ts": ts, "args": {"value": arg}})
+
+    for cpu in sorted({ev[3] for ev in events}):
+        out.append({"ph": "M", "name": "process_name", "pid": cpu, "args": {"name": "CPU %d" % cpu}})
+        out.append({"ph": "M", "name": "thread_name", "pid": cpu, "tid": ISR_TID,
+                    "args": {"name": "ISR"}})
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--log", help="console output with a trace_dump()")
+    source.add_argument("--bin", help="raw memory dump of trace_ring")
+    parser.add_argument("--elf", help="zephyr.elf or zephyr.exe, for symbol names")
+    parser.add_argument("--nm", default="nm", help="nm of the toolchain, e.g. arm-zephyr-eabi-nm")
+    parser.add_argument("--cycles-per-sec", type=int, default=0,
+                        help="cycle counter rate, if the dump was taken before it was filled in")
+    parser.add_argument("--out", default="trace.json", help="Chrome trace JSON to write")
+    args = parser.parse_args()
+
+    events, cps, threads = read_log(args.log) if args.log else read_bin(args.bin)
+    cps = args.cycles_per_sec or cps
+    if not cps:
+        sys.exit("cycles per second unknown, pass --cycles-per-sec")
+    symbols = elf_symbols(args.elf, args.nm) if args.elf else {}
+
+    trace = convert(events, cps, threads, symbols)
+    with open(args.out, "w") as f:
+        json.dump({"traceEvents": trace, "displayTimeUnit": "ns"}, f)
+
+    span_ms = (to_us(events, cps)[-1] / 1000) if events else 0
+    print("%d events over %.1f ms written to %s" % (len(events), span_ms, args.out))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,238 @@
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/sys/printk.h>
+#include <string.h>
+
+#include "thread_stats.h"
+
+#if defined(CONFIG_THREAD_RUNTIME_STATS) && defined(CONFIG_THREAD_STACK_INFO) && \
+    defined(CONFIG_THREAD_MONITOR)
+
+static struct thread_stats_entry table[THREAD_STATS_MAX_THREADS];
+static int table_len = 0;
+static uint32_t generation = 0;
+static uint64_t last_sample_cycles = 0;
+static uint64_t period_cycles = 0; // wall-clock cycles of the last period
+static uint32_t dropped_threads = 0;
+
+static struct k_work_delayable report_work;
+static k_timeout_t report_period;
+
+// The POSIX arch (native_sim, bsim) runs threads on host stacks, and has no
+// Zephyr ISR stack to measure
+#if defined(CONFIG_INIT_STACKS) && !defined(CONFIG_ARCH_POSIX)
+#define HAVE_ISR_STACK_INFO 1
+K_KERNEL_STACK_ARRAY_DECLARE(z_interrupt_stacks, CONFIG_MP_MAX_NUM_CPUS, CONFIG_ISR_STACK_SIZE);
+#endif
+
+static struct thread_stats_entry *entry_for(const struct k_thread *thread)
+{
+    for (int i = 0; i < table_len; i++)
+    {
+        if (table[i].thread == thread)
+            return &table[i];
+    }
+
+    if (table_len >= THREAD_STATS_MAX_THREADS)
+        return NULL;
+
+    struct thread_stats_entry *entry = &table[table_len++];
+    memset(entry, 0, sizeof(*entry));
+    entry->thread = thread;
+    return entry;
+}
+
+static uint32_t switch_count(const struct k_thread *thread)
+{
+#if defined(CONFIG_SCHED_THREAD_USAGE_ANALYSIS)
+    // One usage window is opened every time the thread is switched in
+    return thread->base.usage.num_windows;
+#else
+    return 0;
+#endif
+}
+
+static void sample_thread(const struct k_thread *cthread, void *user_data)
+{
+    struct k_thread *thread = (struct k_thread *)cthread;
+    struct thread_stats_entry *entry = entry_for(thread);
+    if (!entry)
+    {
+        dropped_threads++;
+        return;
+    }
+
+    bool first = entry->seen == 0;
+    k_thread_runtime_stats_t rt;
+    size_t unused = 0;
+
+    if (k_thread_runtime_stats_get(thread, &rt) != 0)
+        rt.execution_cycles = entry->cycles;
+
+    uint32_t switches = switch_count(thread);
+
+    if (!first && period_cycles > 0)
+    {
+        uint64_t busy = rt.execution_cycles - entry->cycles;
+        entry->cpu_permille = MIN(busy * 1000U / (period_cycles * arch_num_cpus()), 1000U);
+        entry->switch_rate = (uint64_t)(switches - entry->switches) *
+                             sys_clock_hw_cycles_per_sec() / period_cycles;
+    }
+
+    entry->cycles = rt.execution_cycles;
+    entry->switches = switches;
+    entry->seen = generation;
+
+    const char *name = k_thread_name_get(thread);
+    if (name && name[0])
+        strncpy(entry->name, name, sizeof(entry->name) - 1);
+    else
+        snprintk(entry->name, sizeof(entry->name), "%p", thread);
+
+    entry->stack_size = thread->stack_info.size;
+    if (k_thread_stack_space_get(thread, &unused) == 0)
+        entry->stack_used = entry->stack_size - unused;
+}
+
+int thread_stats_sample(void)
+{
+    uint64_t now = k_cycle_get_64();
+
+    generation++;
+    period_cycles = last_sample_cycles ? now - last_sample_cycles : 0;
+    last_sample_cycles = now;
+
+    k_thread_foreach_unlocked(sample_thread, NULL);
+
+    // Forget threads that have exited since the last sample
+    int kept = 0;
+    for (int i = 0; i < table_len; i++)
+    {
+        if (table[i].seen == generation)
+            table[kept++] = table[i];
+    }
+    table_len = kept;
+
+    return table_len;
+}
+
+const struct thread_stats_entry *thread_stats_get(int index)
+{
+    if (index < 0 || index >= table_len)
+        return NULL;
+
+    return &table[index];
+}
+
+void thread_stats_print(void)
+{
+    thread_stats_sample();
+
+    printk("%-16s %6s %6s %13s\n", "thread", "cpu%", "sw/s", "stack");
+    for (int i = 0; i < table_len; i++)
+    {
+        const struct thread_stats_entry *e = &table[i];
+        printk("%-16s %4u.%u %6u %5u/%-5u %3u%%\n", e->name,
+               e->cpu_permille / 10, e->cpu_permille % 10, e->switch_rate,
+               (unsigned int)e->stack_used, (unsigned int)e->stack_size,
+               e->stack_size ? (unsigned int)(e->stack_used * 100 / e->stack_size) : 0);
+    }
+
+    if (dropped_threads)
+        printk("(%u thread samples did not fit in the table)\n", dropped_threads);
+}
+
+#if defined(HAVE_ISR_STACK_INFO)
+// Stacks grow down and are painted with 0xaa, so the untouched bytes are at
+// the bottom
+static size_t painted_bytes(const uint8_t *buf, size_t size)
+{
+    size_t unused = 0;
+
+    while (unused < size && buf[unused] == 0xaa)
+        unused++;
+
+    return unused;
+}
+#endif
+
+void thread_stats_print_stacks(void)
+{
+    thread_stats_sample();
+
+    for (int i = 0; i < table_len; i++)
+    {
+        const struct thread_stats_entry *e = &table[i];
+        printk("stack: \"%s\" used=%u size=%u\n", e->name,
+               (unsigned int)e->stack_used, (unsigned int)e->stack_size);
+    }
+
+#if defined(HAVE_ISR_STACK_INFO)
+    for (unsigned int cpu = 0; cpu < arch_num_cpus(); cpu++)
+    {
+        const uint8_t *buf = (const uint8_t *)K_KERNEL_STACK_BUFFER(z_interrupt_stacks[cpu]);
+        size_t size = K_KERNEL_STACK_SIZEOF(z_interrupt_stacks[cpu]);
+
+        printk("stack: \"isr%u\" used=%u size=%u\n", cpu,
+               (unsigned int)(size - painted_bytes(buf, size)), (unsigned int)size);
+    }
+#endif
+}
+
+static void report_work_handler(struct k_work *work)
+{
+    if (IS_ENABLED(CONFIG_APP_STACK_REPORT))
+        thread_stats_print_stacks();
+    else
+        thread_stats_print();
+
+    k_work_schedule(&report_work, report_period);
+}
+
+void thread_stats_start(k_timeout_t period)
+{
+    report_period = period;
+    k_work_init_delayable(&report_work, report_work_handler);
+
+    // Take a baseline now so the first report has a full period to compare to
+    thread_stats_sample();
+    k_work_schedule(&report_work, period);
+}
+
+#if defined(CONFIG_APP_STACK_REPORT)
+static int stack_report_init(void)
+{
+    thread_stats_start(K_MSEC(CONFIG_APP_STACK_REPORT_PERIOD_MS));
+    return 0;
+}
+
+SYS_INIT(stack_report_init, APPLICATION, 99);
+#endif
+
+#else
+
+int thread_stats_sample(void)
+{
+    return 0;
+}
+
+void thread_stats_print(void)
+{
+}
+
+void thread_stats_print_stacks(void)
+{
+}
+
+void thread_stats_start(k_timeout_t period)
+{
+    ARG_UNUSED(period);
+}
+
+const struct thread_stats_entry *thread_stats_get(int index)
+{
+    ARG_UNUSED(index);
+    return NULL;
+}
+
+#endif
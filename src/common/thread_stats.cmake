@@ -0,0 +1,5 @@
+# Shared thread statistics (thread_stats.c). Include from a sample's
+# CMakeLists.txt after find_package(Zephyr):
+#   include(${CMAKE_CURRENT_SOURCE_DIR}/../common/thread_stats.cmake)
+target_sources(app PRIVATE ${CMAKE_CURRENT_LIST_DIR}/thread_stats.c)
+target_include_directories(app PRIVATE ${CMAKE_CURRENT_LIST_DIR})
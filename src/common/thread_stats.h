@@ -0,0 +1,48 @@
+#ifndef THREAD_STATS_H_
+#define THREAD_STATS_H_
+
+#include <zephyr/kernel.h>
+
+// Per-thread CPU usage, context switches and stack high-water marks, sampled
+// into a fixed-size table (no allocation). Shared by the samples: include
+// ../common/thread_stats.cmake from the app and build with
+// -DEXTRA_CONF_FILE=../common/thread_stats.conf. Without those Kconfig
+// options the functions below compile to no-ops.
+//
+// With CONFIG_APP_STACK_REPORT (../common/Kconfig) the stack report is
+// printed periodically from boot, no code changes needed.
+
+#define THREAD_STATS_MAX_THREADS 16
+#define THREAD_STATS_NAME_LEN 16
+
+struct thread_stats_entry
+{
+    const struct k_thread *thread;
+    char name[THREAD_STATS_NAME_LEN];
+    uint64_t cycles;       // execution cycles at the last sample
+    uint32_t switches;     // times switched in, at the last sample
+    uint16_t cpu_permille; // share of the last period, in 0.1 %
+    uint32_t switch_rate;  // switches per second over the last period
+    size_t stack_size;
+    size_t stack_used;     // high-water mark since the thread started
+    uint32_t seen;         // sample generation the thread was last seen in
+};
+
+// Walk all threads and update the table. Returns the number of entries.
+int thread_stats_sample(void);
+
+// Sample and print one compact line per thread with printk()
+void thread_stats_print(void);
+
+// Sample and print the stack usage of every thread and of the ISR stack(s)
+// as 'stack: "<name>" used=<bytes> size=<bytes>' lines, for
+// scripts/stack_overlay.py
+void thread_stats_print_stacks(void);
+
+// Print a report every 'period' from the system workqueue
+void thread_stats_start(k_timeout_t period);
+
+// Read back entry 'index' of the last sample. Returns NULL past the end.
+const struct thread_stats_entry *thread_stats_get(int index);
+
+#endif /* THREAD_STATS_H_ */
@@ -0,0 +1,155 @@
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+
+#include "trace.h"
+
+#if defined(CONFIG_APP_TRACE)
+
+#define CAPACITY CONFIG_APP_TRACE_EVENTS
+#define EVENTS_PER_LINE 4
+
+BUILD_ASSERT(IS_POWER_OF_TWO(CAPACITY), "CONFIG_APP_TRACE_EVENTS must be a power of two");
+BUILD_ASSERT(sizeof(struct trace_event) == 12, "the decoder expects 12-byte events");
+
+// Not static, so a debugger can dump it by name (see trace_to_perfetto.py)
+struct
+{
+    struct trace_header hdr;
+    struct trace_event events[CAPACITY];
+} trace_ring = {
+    .hdr = {.magic = TRACE_MAGIC, .capacity = CAPACITY},
+};
+
+static struct k_spinlock lock;
+static volatile bool paused;
+
+static inline uint8_t cpu_id(void)
+{
+#if defined(CONFIG_SMP)
+    return arch_curr_cpu()->id;
+#else
+    return 0;
+#endif
+}
+
+void trace_record(enum trace_type type, uint32_t arg, int16_t extra)
+{
+    if (paused)
+        return;
+
+    // Also keeps ISRs from interleaving with a half-written event
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    struct trace_event *ev = &trace_ring.events[trace_ring.hdr.head++ & (CAPACITY - 1)];
+
+    ev->timestamp = k_cycle_get_32();
+    ev->arg = arg;
+    ev->type = type;
+    ev->cpu = cpu_id();
+    ev->extra = extra;
+    k_spin_unlock(&lock, key);
+}
+
+/* ==================== */
+/* Kernel tracing hooks */
+/* ==================== */
+
+// Weak in the kernel, called with CONFIG_TRACING_USER
+void sys_trace_thread_switched_in_user(void)
+{
+    trace_record(TRACE_THREAD_SWITCH, (uint32_t)(uintptr_t)k_current_get(), 0);
+}
+
+void sys_trace_isr_enter_user(int nested_interrupts)
+{
+    trace_record(TRACE_ISR_ENTER, 0, nested_interrupts);
+}
+
+void sys_trace_isr_exit_user(int nested_interrupts)
+{
+    trace_record(TRACE_ISR_EXIT, 0, nested_interrupts);
+}
+
+// The real kernel functions, renamed by -Wl,--wrap (see trace.cmake)
+int __real_z_impl_k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout);
+int __real_z_impl_k_mutex_unlock(struct k_mutex *mutex);
+
+int __wrap_z_impl_k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout)
+{
+    trace_record(TRACE_MUTEX_LOCK, (uint32_t)(uintptr_t)mutex, 0);
+    int ret = __real_z_impl_k_mutex_lock(mutex, timeout);
+    trace_record(TRACE_MUTEX_LOCKED, (uint32_t)(uintptr_t)mutex, ret);
+    return ret;
+}
+
+int __wrap_z_impl_k_mutex_unlock(struct k_mutex *mutex)
+{
+    trace_record(TRACE_MUTEX_UNLOCK, (uint32_t)(uintptr_t)mutex, 0);
+    return __real_z_impl_k_mutex_unlock(mutex);
+}
+
+/* ==== */
+/* Dump */
+/* ==== */
+
+static void print_thread(const struct k_thread *thread, void *user_data)
+{
+    const char *name = k_thread_name_get((k_tid_t)thread);
+
+    printk("trace: thread %08x %s\n", (uint32_t)(uintptr_t)thread,
+           name && name[0] ? name : "-");
+}
+
+void trace_dump(void)
+{
+    char hex[EVENTS_PER_LINE * sizeof(struct trace_event) * 2 + 1];
+
+    // Recording stops while printing, or the dump would mostly show itself
+    paused = true;
+
+    uint32_t head = trace_ring.hdr.head;
+    uint32_t count = MIN(head, CAPACITY);
+
+    printk("trace: begin magic %08x cycles_per_sec %u capacity %u head %u count %u\n",
+           TRACE_MAGIC, trace_ring.hdr.cycles_per_sec, CAPACITY, head, count);
+    k_thread_foreach(print_thread, NULL);
+
+    // Oldest event first, raw little-endian bytes as they sit in RAM
+    for (uint32_t i = 0; i < count;)
+    {
+        uint32_t first = (head - count + i) & (CAPACITY - 1);
+        // Lines stop at the end of the ring, the next one starts at slot 0
+        uint32_t n = MIN(MIN(count - i, EVENTS_PER_LINE), CAPACITY - first);
+
+        bin2hex((const uint8_t *)&trace_ring.events[first], n * sizeof(struct trace_event), hex,
+                sizeof(hex));
+        printk("trace: data %s\n", hex);
+        i += n;
+    }
+
+    printk("trace: end\n");
+    paused = false;
+}
+
+#if CONFIG_APP_TRACE_DUMP_MS > 0
+static void dump_work_handler(struct k_work *work)
+{
+    trace_dump();
+}
+
+static K_WORK_DELAYABLE_DEFINE(dump_work, dump_work_handler);
+#endif
+
+static int trace_init(void)
+{
+    trace_ring.hdr.cycles_per_sec = sys_clock_hw_cycles_per_sec();
+#if CONFIG_APP_TRACE_DUMP_MS > 0
+    k_work_schedule(&dump_work, K_MSEC(CONFIG_APP_TRACE_DUMP_MS));
+#endif
+    return 0;
+}
+
+SYS_INIT(trace_init, APPLICATION, 99);
+
+#endif /* CONFIG_APP_TRACE */
@@ -0,0 +1,13 @@
+# Shared binary event trace (trace.c). Include from a sample's CMakeLists.txt
+# after find_package(Zephyr):
+#   include(${CMAKE_CURRENT_SOURCE_DIR}/../common/trace.cmake)
+target_sources(app PRIVATE ${CMAKE_CURRENT_LIST_DIR}/trace.c)
+target_include_directories(app PRIVATE ${CMAKE_CURRENT_LIST_DIR})
+
+# Route every k_mutex_lock()/k_mutex_unlock() through the trace
+if(CONFIG_APP_TRACE)
+  zephyr_ld_options(
+    -Wl,--wrap=z_impl_k_mutex_lock
+    -Wl,--wrap=z_impl_k_mutex_unlock
+  )
+endif()
@@ -0,0 +1,69 @@
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <zephyr/kernel.h>
+
+// Binary event trace in a RAM ring. Thread switches and ISR entry/exit come
+// from the kernel's user tracing hooks (CONFIG_TRACING_USER), mutex events
+// from link-time wrappers of k_mutex_lock()/k_mutex_unlock(), and markers
+// from TRACE_MARK(). Recording an event is a timestamp and a few stores
+// under a short interrupt lock, no formatting.
+//
+// Enable with -DEXTRA_CONF_FILE=../common/trace.conf (CONFIG_APP_TRACE) and
+// include ../common/trace.cmake. Decode the dump with
+// ../common/scripts/trace_to_perfetto.py. Without the option TRACE_MARK()
+// compiles to nothing.
+
+#define TRACE_MAGIC 0x54524331 // "TRC1"
+
+enum trace_type
+{
+    TRACE_THREAD_SWITCH = 1, // arg: thread now running
+    TRACE_ISR_ENTER,
+    TRACE_ISR_EXIT,
+    TRACE_MUTEX_LOCK,        // arg: mutex, about to lock
+    TRACE_MUTEX_LOCKED,      // arg: mutex, extra: 0 or a negative error
+    TRACE_MUTEX_UNLOCK,      // arg: mutex
+    TRACE_USER_MARK,         // arg: value, extra: marker id
+};
+
+struct trace_event
+{
+    uint32_t timestamp; // k_cycle_get_32()
+    uint32_t arg;       // pointers are truncated to 32 bits
+    uint8_t type;       // enum trace_type
+    uint8_t cpu;
+    int16_t extra;
+};
+
+// Start of the ring in memory (the trace_ring symbol), followed by
+// 'capacity' events. The decoder also reads raw memory dumps of it.
+struct trace_header
+{
+    uint32_t magic;
+    uint32_t cycles_per_sec;
+    uint32_t capacity; // events, a power of two
+    uint32_t head;     // events written so far, wraps at 2^32
+};
+
+#if defined(CONFIG_APP_TRACE)
+
+void trace_record(enum trace_type type, uint32_t arg, int16_t extra);
+
+// Marker 'id' with a value, shows up as an instant event in Perfetto
+#define TRACE_MARK(id, value) trace_record(TRACE_USER_MARK, (uint32_t)(value), (id))
+
+// Print the ring over the console as hex lines, with a thread name table
+void trace_dump(void);
+
+#else
+
+#define TRACE_MARK(id, value)
+
+static inline void trace_dump(void)
+{
+}
+
+#endif /* CONFIG_APP_TRACE */
+
+#endif /* TRACE_H_ */
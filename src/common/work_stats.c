@@ -0,0 +1,330 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <string.h>
+
+#include "work_stats.h"
+
+#if defined(CONFIG_APP_WORK_STATS)
+
+struct work_stats_item
+{
+    struct k_work *work;
+    uint8_t handler;       // index into handlers[]
+    uint8_t queue;         // index into queues[], valid while 'queued'
+    bool delayable;
+    bool queued;           // submitted through the wrappers and not started yet
+    uint32_t ready_cycles; // submit time, or when a delayable item became due
+};
+
+static struct work_stats_handler handlers[WORK_STATS_MAX_HANDLERS];
+static struct work_stats_item items[WORK_STATS_MAX_ITEMS];
+static struct work_stats_queue queues[WORK_STATS_MAX_QUEUES];
+static int handler_count = 0;
+static int item_count = 0;
+static int queue_count = 0;
+static struct k_spinlock lock;
+
+static const uint32_t bucket_limit_us[WORK_STATS_BUCKETS - 1] = {10, 100, 1000, 10000, 100000};
+
+// Caller holds the lock
+static struct work_stats_item *item_for(const struct k_work *work)
+{
+    for (int i = 0; i < item_count; i++)
+    {
+        if (items[i].work == work)
+            return &items[i];
+    }
+    return NULL;
+}
+
+// Caller holds the lock. Returns -1 when the table is full.
+static int queue_index(const struct k_work_q *queue)
+{
+    for (int i = 0; i < queue_count; i++)
+    {
+        if (queues[i].queue == queue)
+            return i;
+    }
+
+    if (queue_count >= WORK_STATS_MAX_QUEUES)
+        return -1;
+
+    memset(&queues[queue_count], 0, sizeof(queues[0]));
+    queues[queue_count].queue = queue;
+    return queue_count++;
+}
+
+static int bucket_for(uint32_t us)
+{
+    int b = 0;
+    while (b < WORK_STATS_BUCKETS - 1 && us >= bucket_limit_us[b])
+        b++;
+    return b;
+}
+
+// Every instrumented item runs through here
+static void trampoline(struct k_work *work)
+{
+    uint32_t start = k_cycle_get_32();
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    struct work_stats_item *item = item_for(work);
+    if (!item)
+    {
+        // Only registered items get the trampoline as their handler
+        k_spin_unlock(&lock, key);
+        return;
+    }
+
+    struct work_stats_handler *h = &handlers[item->handler];
+    if (item->queued)
+    {
+        // A delayable item that is not due yet cannot run, so a start before
+        // 'ready_cycles' only means it was rescheduled in the meantime
+        int32_t wait = (int32_t)(start - item->ready_cycles);
+        uint32_t wait_us = wait > 0 ? k_cyc_to_us_floor32(wait) : 0;
+
+        h->waits++;
+        h->total_wait_us += wait_us;
+        if (wait_us > h->max_wait_us)
+            h->max_wait_us = wait_us;
+        if (!item->delayable && queues[item->queue].depth > 0)
+            queues[item->queue].depth--;
+        item->queued = false;
+    }
+    k_work_handler_t handler = h->handler;
+    k_spin_unlock(&lock, key);
+
+    handler(work);
+
+    uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+    bool report = false;
+
+    key = k_spin_lock(&lock);
+    h->runs++;
+    h->total_us += us;
+    h->hist[bucket_for(us)]++;
+    if (us > CONFIG_APP_WORK_STATS_BUDGET_US)
+    {
+        // Report the first overrun and every new worst case, not every run
+        report = h->over_budget == 0 || us > h->max_us;
+        h->over_budget++;
+    }
+    if (us > h->max_us)
+        h->max_us = us;
+    k_spin_unlock(&lock, key);
+
+    if (report)
+        printk("work: %s ran %u us, budget is %u us\n", h->name, us,
+               CONFIG_APP_WORK_STATS_BUDGET_US);
+}
+
+static void register_item(struct k_work *work, k_work_handler_t handler, const char *name,
+                          bool delayable)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    int h = 0;
+    while (h < handler_count && handlers[h].handler != handler)
+        h++;
+
+    struct work_stats_item *item = item_for(work);
+    if (!item && item_count < WORK_STATS_MAX_ITEMS)
+        item = &items[item_count++];
+
+    if (!item || (h == handler_count && handler_count >= WORK_STATS_MAX_HANDLERS))
+    {
+        // Table full: the item still works, it just is not measured
+        k_spin_unlock(&lock, key);
+        printk("work: no room to track %s\n", name);
+        k_work_init(work, handler);
+        return;
+    }
+
+    if (h == handler_count)
+    {
+        memset(&handlers[h], 0, sizeof(handlers[h]));
+        handlers[h].handler = handler;
+        handlers[h].name = name;
+        handler_count++;
+    }
+
+    item->work = work;
+    item->handler = h;
+    item->delayable = delayable;
+    item->queued = false;
+    k_spin_unlock(&lock, key);
+}
+
+void work_stats_init_named(struct k_work *work, k_work_handler_t handler, const char *name)
+{
+    k_work_init(work, trampoline);
+    register_item(work, handler, name, false);
+}
+
+void work_stats_init_delayable_named(struct k_work_delayable *dwork, k_work_handler_t handler,
+                                     const char *name)
+{
+    k_work_init_delayable(dwork, trampoline);
+    register_item(&dwork->work, handler, name, true);
+}
+
+// Marks the item queued before handing it to the kernel: a higher priority
+// workqueue may start it before the submit call even returns.
+// Returns the item if it was marked. Caller holds the lock.
+static struct work_stats_item *mark_queued(struct k_work_q *queue, struct k_work *work,
+                                          uint32_t ready_cycles)
+{
+    struct work_stats_item *item = item_for(work);
+    int q = queue_index(queue);
+
+    // Already queued items keep their original submit time
+    if (!item || q < 0 || item->queued)
+        return NULL;
+
+    item->ready_cycles = ready_cycles;
+    item->queue = q;
+    item->queued = true;
+    if (!item->delayable && ++queues[q].depth > queues[q].max_depth)
+        queues[q].max_depth = queues[q].depth;
+    return item;
+}
+
+// Undo mark_queued() when the kernel did not queue the item after all
+static void unmark_queued(struct work_stats_item *item)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    if (item->queued)
+    {
+        item->queued = false;
+        if (!item->delayable && queues[item->queue].depth > 0)
+            queues[item->queue].depth--;
+    }
+    k_spin_unlock(&lock, key);
+}
+
+int work_stats_submit_to_queue(struct k_work_q *queue, struct k_work *work)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    struct work_stats_item *item = mark_queued(queue, work, k_cycle_get_32());
+    k_spin_unlock(&lock, key);
+
+    int ret = k_work_submit_to_queue(queue, work);
+    if (ret <= 0 && item)
+        unmark_queued(item);
+
+    return ret;
+}
+
+int work_stats_schedule_for_queue(struct k_work_q *queue, struct k_work_delayable *dwork,
+                                  k_timeout_t delay)
+{
+    // Delayed items are not counted in the queue depth, their wait is
+    // measured from the moment they became due. Absolute timeouts are
+    // treated as due immediately.
+    uint32_t delay_cycles = 0;
+    if (!K_TIMEOUT_EQ(delay, K_NO_WAIT) && delay.ticks > 0)
+        delay_cycles = k_ticks_to_cyc_floor32(delay.ticks);
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    struct work_stats_item *item =
+        mark_queued(queue, &dwork->work, k_cycle_get_32() + delay_cycles);
+    k_spin_unlock(&lock, key);
+
+    int ret = k_work_schedule_for_queue(queue, dwork, delay);
+    if (ret <= 0 && item)
+        unmark_queued(item);
+
+    return ret;
+}
+
+bool work_stats_handler_get(int index, struct work_stats_handler *out)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    bool valid = index >= 0 && index < handler_count;
+    if (valid)
+        *out = handlers[index];
+    k_spin_unlock(&lock, key);
+    return valid;
+}
+
+bool work_stats_queue_get(int index, struct work_stats_queue *out)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    bool valid = index >= 0 && index < queue_count;
+    if (valid)
+        *out = queues[index];
+    k_spin_unlock(&lock, key);
+    return valid;
+}
+
+void work_stats_reset(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    for (int i = 0; i < handler_count; i++)
+    {
+        k_work_handler_t handler = handlers[i].handler;
+        const char *name = handlers[i].name;
+
+        memset(&handlers[i], 0, sizeof(handlers[i]));
+        handlers[i].handler = handler;
+        handlers[i].name = name;
+    }
+    // Keep the current depth, the items are still queued
+    for (int i = 0; i < queue_count; i++)
+        queues[i].max_depth = queues[i].depth;
+    k_spin_unlock(&lock, key);
+}
+
+#else
+
+bool work_stats_handler_get(int index, struct work_stats_handler *out)
+{
+    return false;
+}
+
+bool work_stats_queue_get(int index, struct work_stats_queue *out)
+{
+    return false;
+}
+
+void work_stats_reset(void)
+{
+}
+
+#endif /* CONFIG_APP_WORK_STATS */
+
+const char *work_stats_queue_name(const struct k_work_q *queue)
+{
+    if (queue == &k_sys_work_q)
+        return "sysworkq";
+
+    const char *name = k_thread_name_get((k_tid_t)&queue->thread);
+    return name ? name : "workq";
+}
+
+void work_stats_print(void)
+{
+    struct work_stats_handler h;
+    struct work_stats_queue q;
+
+    if (!IS_ENABLED(CONFIG_APP_WORK_STATS))
+    {
+        printk("work stats disabled, build with CONFIG_APP_WORK_STATS=y\n");
+        return;
+    }
+
+    printk("%-20s %6s %8s %8s %5s %9s  %s\n", "handler", "runs", "avg_us", "max_us", "over",
+           "wait_max", "<10us/<100us/<1ms/<10ms/<100ms/more");
+    for (int i = 0; work_stats_handler_get(i, &h); i++)
+    {
+        printk("%-20s %6u %8u %8u %5u %9u  %u/%u/%u/%u/%u/%u\n", h.name, h.runs,
+               h.runs ? (uint32_t)(h.total_us / h.runs) : 0, h.max_us, h.over_budget,
+               h.max_wait_us, h.hist[0], h.hist[1], h.hist[2], h.hist[3], h.hist[4], h.hist[5]);
+    }
+    for (int i = 0; work_stats_queue_get(i, &q); i++)
+    {
+        printk("queue %-14s depth %u, max %u\n", work_stats_queue_name(q.queue), q.depth,
+               q.max_depth);
+    }
+}
@@ -0,0 +1,5 @@
+# Shared work item statistics (work_stats.c). Include from a sample's CMakeLists.txt
+# after find_package(Zephyr):
+#   include(${CMAKE_CURRENT_SOURCE_DIR}/../common/work_stats.cmake)
+target_sources(app PRIVATE ${CMAKE_CURRENT_LIST_DIR}/work_stats.c)
+target_include_directories(app PRIVATE ${CMAKE_CURRENT_LIST_DIR})
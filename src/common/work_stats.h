@@ -0,0 +1,96 @@
+#ifndef WORK_STATS_H_
+#define WORK_STATS_H_
+
+#include <zephyr/kernel.h>
+
+// Execution-time histograms per work handler, with a long-item detector and
+// the submit-to-start wait and queue depth of every instrumented item. Use
+// the wrappers below instead of k_work_init()/k_work_submit() and friends and
+// include ../common/work_stats.cmake from the app.
+//
+// Enabled with CONFIG_APP_WORK_STATS (../common/Kconfig). Without it the
+// wrappers are the plain kernel calls and nothing is recorded.
+
+#define WORK_STATS_MAX_HANDLERS 16
+#define WORK_STATS_MAX_ITEMS 32
+#define WORK_STATS_MAX_QUEUES 4
+
+// Execution time buckets: <10 us, <100 us, <1 ms, <10 ms, <100 ms, longer
+#define WORK_STATS_BUCKETS 6
+
+struct work_stats_handler
+{
+    k_work_handler_t handler;
+    const char *name;
+    uint32_t runs;
+    uint32_t over_budget;   // runs longer than CONFIG_APP_WORK_STATS_BUDGET_US
+    uint32_t max_us;
+    uint64_t total_us;
+    uint32_t hist[WORK_STATS_BUCKETS];
+    uint32_t waits;         // runs with a known submit time
+    uint32_t max_wait_us;   // worst submit-to-start (or deadline-to-start) time
+    uint64_t total_wait_us;
+};
+
+struct work_stats_queue
+{
+    const struct k_work_q *queue;
+    uint32_t depth;         // instrumented items submitted but not started
+    uint32_t max_depth;
+};
+
+#if defined(CONFIG_APP_WORK_STATS)
+
+void work_stats_init_named(struct k_work *work, k_work_handler_t handler, const char *name);
+void work_stats_init_delayable_named(struct k_work_delayable *dwork, k_work_handler_t handler,
+                                     const char *name);
+int work_stats_submit_to_queue(struct k_work_q *queue, struct k_work *work);
+int work_stats_schedule_for_queue(struct k_work_q *queue, struct k_work_delayable *dwork,
+                                  k_timeout_t delay);
+
+#define WORK_STATS_INIT(work, handler) work_stats_init_named(work, handler, #handler)
+#define WORK_STATS_INIT_DELAYABLE(dwork, handler) \
+    work_stats_init_delayable_named(dwork, handler, #handler)
+
+#else
+
+static inline int work_stats_submit_to_queue(struct k_work_q *queue, struct k_work *work)
+{
+    return k_work_submit_to_queue(queue, work);
+}
+
+static inline int work_stats_schedule_for_queue(struct k_work_q *queue,
+                                                struct k_work_delayable *dwork, k_timeout_t delay)
+{
+    return k_work_schedule_for_queue(queue, dwork, delay);
+}
+
+#define WORK_STATS_INIT(work, handler) k_work_init(work, handler)
+#define WORK_STATS_INIT_DELAYABLE(dwork, handler) k_work_init_delayable(dwork, handler)
+
+#endif /* CONFIG_APP_WORK_STATS */
+
+static inline int work_stats_submit(struct k_work *work)
+{
+    return work_stats_submit_to_queue(&k_sys_work_q, work);
+}
+
+static inline int work_stats_schedule(struct k_work_delayable *dwork, k_timeout_t delay)
+{
+    return work_stats_schedule_for_queue(&k_sys_work_q, dwork, delay);
+}
+
+// Copy out handler or queue 'index'. Return false past the end, or when
+// CONFIG_APP_WORK_STATS is off.
+bool work_stats_handler_get(int index, struct work_stats_handler *out);
+bool work_stats_queue_get(int index, struct work_stats_queue *out);
+
+// Printable name of a queue, "sysworkq" for the system workqueue
+const char *work_stats_queue_name(const struct k_work_q *queue);
+
+void work_stats_reset(void);
+
+// Print one line per handler and per queue with printk()
+void work_stats_print(void);
+
+#endif /* WORK_STATS_H_ */
@@ -0,0 +1,249 @@
+#include <zephyr/kernel.h>
+#include <string.h>
+
+#include "wq_pool.h"
+
+struct pool_queue
+{
+    struct k_work_q q;
+    const char *name;
+    int priority;
+    k_thread_stack_t *stack; // NULL when the class is disabled
+    size_t stack_size;
+    sys_slist_t pending; // items submitted here that have not started yet
+    uint32_t in_flight;  // pending + running
+    struct wq_pool_stats stats;
+};
+
+// Only the classes the app enables get a stack and a thread
+#if defined(CONFIG_APP_WQ_POOL_LATENCY)
+K_THREAD_STACK_DEFINE(latency_stack, CONFIG_APP_WQ_POOL_LATENCY_STACK_SIZE);
+#endif
+#if defined(CONFIG_APP_WQ_POOL_BULK)
+K_THREAD_STACK_DEFINE(bulk_stack, CONFIG_APP_WQ_POOL_BULK_STACK_SIZE);
+#endif
+#if defined(CONFIG_APP_WQ_POOL_BACKGROUND)
+K_THREAD_STACK_DEFINE(background_stack, CONFIG_APP_WQ_POOL_BACKGROUND_STACK_SIZE);
+#endif
+
+static struct pool_queue queues[WQ_CLASS_COUNT] = {
+#if defined(CONFIG_APP_WQ_POOL_LATENCY)
+    [WQ_CLASS_LATENCY] = {.name = "wq_latency",
+                          .priority = K_PRIO_PREEMPT(2),
+                          .stack = latency_stack,
+                          .stack_size = K_THREAD_STACK_SIZEOF(latency_stack)},
+#endif
+#if defined(CONFIG_APP_WQ_POOL_BULK)
+    [WQ_CLASS_BULK] = {.name = "wq_bulk",
+                       .priority = K_PRIO_PREEMPT(10),
+                       .stack = bulk_stack,
+                       .stack_size = K_THREAD_STACK_SIZEOF(bulk_stack)},
+#endif
+#if defined(CONFIG_APP_WQ_POOL_BACKGROUND)
+    [WQ_CLASS_BACKGROUND] = {.name = "wq_background",
+                             .priority = K_PRIO_PREEMPT(14),
+                             .stack = background_stack,
+                             .stack_size = K_THREAD_STACK_SIZEOF(background_stack)},
+#endif
+};
+
+static struct k_spinlock lock;
+static bool stealing = false;
+static bool initialized = false;
+
+static void steal_into(uint8_t thief);
+
+static bool enabled(uint8_t index)
+{
+    return queues[index].stack != NULL;
+}
+
+// Every pool item runs through here so the pool can keep its bookkeeping
+static void trampoline(struct k_work *work)
+{
+    struct wq_pool_work *item = CONTAINER_OF(work, struct wq_pool_work, work);
+    struct pool_queue *pq = &queues[item->queue];
+    uint8_t index = item->queue;
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    sys_slist_find_and_remove(&pq->pending, &item->node);
+
+    uint32_t wait_us = k_cyc_to_us_floor32(k_cycle_get_32() - item->submit_cycles);
+    pq->stats.executed++;
+    pq->stats.total_wait_us += wait_us;
+    if (wait_us > pq->stats.max_wait_us)
+        pq->stats.max_wait_us = wait_us;
+    if (index != item->cls)
+        pq->stats.stolen++;
+    k_spin_unlock(&lock, key);
+
+    item->handler(work);
+
+    key = k_spin_lock(&lock);
+    pq->in_flight--;
+    bool idle = pq->in_flight == 0;
+    k_spin_unlock(&lock, key);
+
+    if (idle && stealing && index != WQ_CLASS_LATENCY)
+        steal_into(index);
+}
+
+// Returns what k_work_submit_to_queue() returned
+static int queue_on(struct wq_pool_work *item, uint8_t index)
+{
+    struct pool_queue *pq = &queues[index];
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    item->queue = index;
+    item->submit_cycles = k_cycle_get_32();
+    // A racing submit may have linked it already, never link it twice
+    sys_slist_find_and_remove(&pq->pending, &item->node);
+    sys_slist_append(&pq->pending, &item->node);
+    pq->in_flight++;
+    k_spin_unlock(&lock, key);
+
+    int ret = k_work_submit_to_queue(&pq->q, &item->work);
+    if (ret <= 0)
+    {
+        // Already queued (that submit holds the count and the node), or refused
+        key = k_spin_lock(&lock);
+        if (ret < 0)
+            sys_slist_find_and_remove(&pq->pending, &item->node);
+        pq->in_flight--;
+        k_spin_unlock(&lock, key);
+    }
+    return ret;
+}
+
+// Move one pending bulk item from a busy queue onto the idle 'thief' queue
+static void steal_into(uint8_t thief)
+{
+    for (uint8_t victim = WQ_CLASS_BULK; victim < WQ_CLASS_COUNT; victim++)
+    {
+        if (victim == thief || !enabled(victim))
+            continue;
+
+        struct wq_pool_work *item = NULL;
+        struct wq_pool_work *cur;
+
+        // Only an item that has not started yet can be moved. One that was
+        // resubmitted while running is queued too, but cancelling it would
+        // drop the resubmission, so it stays. Checked and cancelled in the
+        // same critical section that unlinks it, and only unlinked if the
+        // cancel was clean.
+        k_spinlock_key_t key = k_spin_lock(&lock);
+        SYS_SLIST_FOR_EACH_CONTAINER(&queues[victim].pending, cur, node)
+        {
+            if (cur->cls != WQ_CLASS_BULK || (k_work_busy_get(&cur->work) & K_WORK_RUNNING))
+                continue;
+
+            if (k_work_cancel(&cur->work) == 0)
+            {
+                item = cur;
+                break;
+            }
+        }
+        if (item)
+        {
+            sys_slist_find_and_remove(&queues[victim].pending, &item->node);
+            queues[victim].in_flight--;
+        }
+        k_spin_unlock(&lock, key);
+
+        if (!item)
+            continue;
+
+        // Back where it came from if the idle queue refuses it
+        if (queue_on(item, thief) < 0)
+            queue_on(item, victim);
+        return;
+    }
+}
+
+int wq_pool_init(void)
+{
+    if (initialized)
+        return 0;
+
+    for (int i = 0; i < WQ_CLASS_COUNT; i++)
+    {
+        struct pool_queue *pq = &queues[i];
+        const struct k_work_queue_config cfg = {.name = pq->name};
+
+        sys_slist_init(&pq->pending);
+        if (!enabled(i))
+            continue;
+
+        k_work_queue_init(&pq->q);
+        k_work_queue_start(&pq->q, pq->stack, pq->stack_size, pq->priority, &cfg);
+    }
+
+    initialized = true;
+    return 0;
+}
+
+void wq_pool_work_init(struct wq_pool_work *item, k_work_handler_t handler, enum wq_class cls)
+{
+    memset(item, 0, sizeof(*item));
+    k_work_init(&item->work, trampoline);
+    item->handler = handler;
+    item->cls = cls;
+}
+
+int wq_pool_submit(struct wq_pool_work *item)
+{
+    if (!initialized)
+        return -EAGAIN;
+    if (!enabled(item->cls))
+        return -ENOTSUP;
+
+    if (k_work_is_pending(&item->work))
+        return 0;
+
+    uint8_t index = item->cls;
+
+    // The kernel requeues a running item on the queue it is running on
+    if (k_work_busy_get(&item->work) & K_WORK_RUNNING)
+    {
+        int ret = queue_on(item, item->queue);
+        return ret > 0 ? 1 : ret;
+    }
+
+    // A new bulk item would wait behind whatever the bulk queue is doing,
+    // hand it to the background queue if that one has nothing to do
+    if (stealing && item->cls == WQ_CLASS_BULK && enabled(WQ_CLASS_BACKGROUND))
+    {
+        k_spinlock_key_t key = k_spin_lock(&lock);
+        if (queues[WQ_CLASS_BULK].in_flight > 0 && queues[WQ_CLASS_BACKGROUND].in_flight == 0)
+            index = WQ_CLASS_BACKGROUND;
+        k_spin_unlock(&lock, key);
+    }
+
+    int ret = queue_on(item, index);
+    return ret > 0 ? 1 : ret;
+}
+
+void wq_pool_stealing_set(bool enable)
+{
+    stealing = enable;
+}
+
+struct k_work_q *wq_pool_queue(enum wq_class cls)
+{
+    return enabled(cls) ? &queues[cls].q : NULL;
+}
+
+void wq_pool_stats_get(enum wq_class cls, struct wq_pool_stats *stats)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    *stats = queues[cls].stats;
+    k_spin_unlock(&lock, key);
+}
+
+void wq_pool_stats_reset(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    for (int i = 0; i < WQ_CLASS_COUNT; i++)
+        memset(&queues[i].stats, 0, sizeof(queues[i].stats));
+    k_spin_unlock(&lock, key);
+}
@@ -0,0 +1,5 @@
+# Shared workqueue pool (wq_pool.c). Include from a sample's CMakeLists.txt
+# after find_package(Zephyr):
+#   include(${CMAKE_CURRENT_SOURCE_DIR}/../common/wq_pool.cmake)
+target_sources(app PRIVATE ${CMAKE_CURRENT_LIST_DIR}/wq_pool.c)
+target_include_directories(app PRIVATE ${CMAKE_CURRENT_LIST_DIR})
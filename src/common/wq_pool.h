@@ -0,0 +1,62 @@
+#ifndef WQ_POOL_H_
+#define WQ_POOL_H_
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/slist.h>
+
+// A small pool of dedicated workqueues, one per class of work, so a long
+// item can no longer delay short ones the way it does on the shared system
+// workqueue. Include ../common/wq_pool.cmake from the app and call
+// wq_pool_init() once before submitting. Each class has its own
+// CONFIG_APP_WQ_POOL_<class> enable and stack size, a disabled class has no
+// thread and its items are refused.
+
+enum wq_class
+{
+    WQ_CLASS_LATENCY,    // short, time-critical items (advertising restarts, I/O)
+    WQ_CLASS_BULK,       // longer processing
+    WQ_CLASS_BACKGROUND, // housekeeping, runs only when nothing else does
+    WQ_CLASS_COUNT,
+};
+
+struct wq_pool_work
+{
+    struct k_work work;
+    k_work_handler_t handler;
+    enum wq_class cls;
+
+    // Private
+    sys_snode_t node;
+    uint32_t submit_cycles;
+    uint8_t queue; // index of the queue it was last submitted to
+};
+
+struct wq_pool_stats
+{
+    uint32_t executed;
+    uint32_t stolen;       // items run by another queue than their own
+    uint32_t max_wait_us;  // worst submit-to-start time
+    uint64_t total_wait_us;
+};
+
+int wq_pool_init(void);
+
+// The handler receives &item->work, use CONTAINER_OF() to get back to the item
+void wq_pool_work_init(struct wq_pool_work *item, k_work_handler_t handler, enum wq_class cls);
+
+// Returns 1 if queued, 0 if it was already pending, -ENOTSUP if the item's
+// class is disabled, or another negative error
+int wq_pool_submit(struct wq_pool_work *item);
+
+// When enabled, an idle non-latency queue takes bulk items that are still
+// pending on another queue, and new bulk items go straight to an idle queue
+// while the bulk queue is busy.
+void wq_pool_stealing_set(bool enable);
+
+// NULL if the class is disabled
+struct k_work_q *wq_pool_queue(enum wq_class cls);
+
+void wq_pool_stats_get(enum wq_class cls, struct wq_pool_stats *stats);
+void wq_pool_stats_reset(void);
+
+#endif /* WQ_POOL_H_ */
@@ -0,0 +1,155 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/reboot.h>
+
+#include <nfc_t2t_lib.h>
+
+#include "ndef_builder.h"
+
+/* Built instead of main.c with overlay-live.conf. Serves "Hello World!"
+ * and a second text record with a counter that changes every second.
+ *
+ * The message lives in two buffers. The reader only ever sees the front
+ * one; updates patch the counter record in the back one, and the two swap
+ * while no phone is in the field (at NFC_T2T_EVENT_FIELD_OFF, or right away
+ * if the field is already off), so a phone never reads a half-written
+ * message. After a swap the new back buffer is brought up to date with
+ * ndef_builder_copy().
+ */
+
+#define NFC_BUFFER_SIZE 128
+#define COUNTER_TEXT_MAX 10
+#define UPDATE_PERIOD K_SECONDS(1)
+
+static uint8_t nfc_bufs[2][NFC_BUFFER_SIZE];
+static struct ndef_builder msgs[2];
+static int front;
+static int counter_rec;
+static uint32_t counter;
+
+/* Set from the NFC event handler, the work items run on the system workqueue */
+static atomic_t field_on;
+static bool pending;
+
+static void swap_work_handler(struct k_work *work);
+static void update_work_handler(struct k_work *work);
+
+static K_WORK_DEFINE(swap_work, swap_work_handler);
+static K_WORK_DELAYABLE_DEFINE(update_work, update_work_handler);
+
+/* Callback to handle NFC field events */
+static void nfc_event_handler(void *ctx, nfc_t2t_event_t evt,
+							  const uint8_t *data, size_t len)
+{
+	ARG_UNUSED(ctx);
+	ARG_UNUSED(data);
+	ARG_UNUSED(len);
+
+	switch (evt)
+	{
+	case NFC_T2T_EVENT_FIELD_ON:
+		atomic_set(&field_on, 1);
+		break;
+	case NFC_T2T_EVENT_FIELD_OFF:
+		atomic_set(&field_on, 0);
+		k_work_submit(&swap_work);
+		break;
+	default:
+		break;
+	}
+}
+
+static void swap_work_handler(struct k_work *work)
+{
+	if (!pending || atomic_get(&field_on))
+	{
+		return;
+	}
+
+	int back = !front;
+
+	/* The library serves the payload in place, so it can't change while
+	 * emulation runs
+	 */
+	nfc_t2t_emulation_stop();
+	if (nfc_t2t_payload_set(ndef_builder_data(&msgs[back]),
+							ndef_builder_len(&msgs[back])) < 0)
+	{
+		printk("Unable to load NFC data\n");
+		nfc_t2t_payload_set(ndef_builder_data(&msgs[front]), ndef_builder_len(&msgs[front]));
+		nfc_t2t_emulation_start();
+		return;
+	}
+	nfc_t2t_emulation_start();
+
+	front = back;
+	ndef_builder_copy(&msgs[!front], &msgs[front]);
+	pending = false;
+}
+
+static void update_work_handler(struct k_work *work)
+{
+	char text[COUNTER_TEXT_MAX + 1];
+	int len = snprintk(text, sizeof(text), "%u", ++counter);
+
+	if (ndef_builder_set_text(&msgs[!front], counter_rec, text, len) == 0)
+	{
+		pending = true;
+		k_work_submit(&swap_work);
+	}
+
+	k_work_reschedule(&update_work, UPDATE_PERIOD);
+}
+
+static int build_message(struct ndef_builder *msg, uint8_t *buf)
+{
+	ndef_builder_init(msg, buf, NFC_BUFFER_SIZE, false);
+
+	int ret = ndef_builder_add_text(msg, "en", "Hello World!", 12);
+	if (ret < 0)
+	{
+		return ret;
+	}
+
+	counter_rec = ndef_builder_add_text(msg, "en", "0", COUNTER_TEXT_MAX);
+	return counter_rec;
+}
+
+int main(void)
+{
+	printk("Starting live NFC demo\n");
+
+	if (nfc_t2t_setup(nfc_event_handler, NULL) < 0)
+	{
+		printk("Failed to init NFC interface\n");
+		goto error;
+	}
+
+	if (build_message(&msgs[0], nfc_bufs[0]) < 0 ||
+		build_message(&msgs[1], nfc_bufs[1]) < 0)
+	{
+		printk("Payload creation failed\n");
+		goto error;
+	}
+
+	if (nfc_t2t_payload_set(ndef_builder_data(&msgs[front]), ndef_builder_len(&msgs[front])) < 0)
+	{
+		printk("Unable to load NFC data\n");
+		goto error;
+	}
+
+	if (nfc_t2t_emulation_start() < 0)
+	{
+		printk("Emulation start failed\n");
+		goto error;
+	}
+
+	k_work_schedule(&update_work, UPDATE_PERIOD);
+	return 0;
+
+error:
+#if CONFIG_REBOOT
+	sys_reboot(SYS_REBOOT_COLD);
+#endif
+	return -EIO;
+}
@@ -2,12 +2,20 @@
 #include <zephyr/sys/reboot.h>
 
 #include <nfc_t2t_lib.h>
+
+#if defined(CONFIG_APP_NDEF_RUNTIME)
 #include <nfc/ndef/msg.h>
 #include <nfc/ndef/text_rec.h>
 
 #define NFC_BUFFER_SIZE 128
 
 static uint8_t nfc_data_buf[NFC_BUFFER_SIZE];
+#else
+/* Encoded from ndef.json at build time by ../common/scripts/ndef_gen.py */
+static const uint8_t ndef_msg[] = {
+#include "ndef_msg.inc"
+};
+#endif
 
 /* Callback to handle NFC field events */
 static void nfc_event_handler(void *ctx, nfc_t2t_event_t evt,
@@ -30,6 +38,7 @@ static void nfc_event_handler(void *ctx, nfc_t2t_event_t evt,
 	}
 }
 
+#if defined(CONFIG_APP_NDEF_RUNTIME)
 /* Generate a basic NDEF text message */
 static int create_text_payload(uint8_t *buf, uint32_t *buf_len)
 {
@@ -49,11 +58,10 @@ static int create_text_payload(uint8_t *buf, uint32_t *buf_len)
 
 	return nfc_ndef_msg_encode(&NFC_NDEF_MSG(ndef_msg), buf, buf_len);
 }
+#endif
 
 int main(void)
 {
-	uint32_t payload_len = sizeof(nfc_data_buf);
-
 	printk("Starting minimal NFC demo\n");
 
 	if (nfc_t2t_setup(nfc_event_handler, NULL) < 0)
@@ -62,13 +70,21 @@ int main(void)
 		goto error;
 	}
 
+#if defined(CONFIG_APP_NDEF_RUNTIME)
+	uint32_t payload_len = sizeof(nfc_data_buf);
+	const uint8_t *payload = nfc_data_buf;
+
 	if (create_text_payload(nfc_data_buf, &payload_len) < 0)
 	{
 		printk("Payload creation failed\n");
 		goto error;
 	}
+#else
+	uint32_t payload_len = sizeof(ndef_msg);
+	const uint8_t *payload = ndef_msg;
+#endif
 
-	if (nfc_t2t_payload_set(nfc_data_buf, payload_len) < 0)
+	if (nfc_t2t_payload_set(payload, payload_len) < 0)
 	{
 		printk("Unable to load NFC data\n");
 		goto error;
@@ -80,6 +96,10 @@ int main(void)
 		goto error;
 	}
 
+	printk("Emulation started %u us after boot (%s NDEF, %u bytes)\n",
+	       (uint32_t)k_ticks_to_us_floor64(k_uptime_ticks()),
+	       IS_ENABLED(CONFIG_APP_NDEF_RUNTIME) ? "runtime" : "build-time", payload_len);
+
 	return 0;
 
 error:
@@ -0,0 +1,171 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <string.h>
+
+#include <nfc/ndef/msg.h>
+#include <nfc/ndef/text_rec.h>
+
+#include "bench_clock.h"
+#include "ndef_builder.h"
+#include "ndef_parse.h"
+
+/* Built instead of main.c with overlay-ndef-bench.conf, runs on native_sim
+ * without the NFC hardware. Compares updating a counter record in place
+ * with ndef_builder_set_text() against encoding the whole message again
+ * with the NCS encoder, nfc_ndef_msg_encode(), the way main.c does with
+ * CONFIG_APP_NDEF_RUNTIME. Messages have 1, 4 and 8 text records. The
+ * counter is the first record, so every record behind it moves when its
+ * length changes.
+ *
+ * The two don't produce the same bytes: ndef_builder writes short records
+ * (SR) for payloads below 256 bytes, the NCS encoder always writes long
+ * ones. The results are compared record by record instead.
+ */
+
+#define BUF_SIZE 1024
+#define RUN_MS 1000
+#define CHECK_EVERY 64 /* iterations between clock checks */
+#define COUNTER_TEXT_MAX 10
+#define STATIC_TEXT "Sensor reading placeholder"
+
+static const int record_counts[] = {1, 4, 8};
+
+static uint8_t patch_buf[BUF_SIZE];
+static uint8_t full_buf[BUF_SIZE];
+static uint32_t full_len;
+
+/* The NCS description of the same message. The counter record's payload
+ * descriptor points at counter_text, only its length changes.
+ */
+static const uint8_t en_code[] = {'e', 'n'};
+static const uint8_t static_text[] = STATIC_TEXT;
+static uint8_t counter_text[COUNTER_TEXT_MAX + 1];
+
+NFC_NDEF_TEXT_RECORD_DESC_DEF(counter_rec, UTF_8, en_code, sizeof(en_code), counter_text, 0);
+NFC_NDEF_TEXT_RECORD_DESC_DEF(static_rec, UTF_8, en_code, sizeof(en_code), static_text,
+			      sizeof(static_text) - 1);
+NFC_NDEF_MSG_DEF(full_msg, 8);
+
+static int build_patch(struct ndef_builder *msg, uint8_t *buf, int records, const char *counter)
+{
+	ndef_builder_init(msg, buf, BUF_SIZE, false);
+
+	int ret = ndef_builder_add_text(msg, "en", counter, COUNTER_TEXT_MAX);
+	for (int i = 1; i < records && ret >= 0; i++)
+	{
+		ret = ndef_builder_add_text(msg, "en", STATIC_TEXT, sizeof(STATIC_TEXT) - 1);
+	}
+	return ret;
+}
+
+/* Runs 'fn' for RUN_MS, returns updates per second */
+static uint32_t run(void (*fn)(uint32_t i, int records), int records)
+{
+	uint32_t i = 0;
+	uint64_t start = bench_clock_ns();
+	uint64_t elapsed;
+
+	do
+	{
+		for (int n = 0; n < CHECK_EVERY; n++, i++)
+		{
+			fn(i, records);
+		}
+		elapsed = bench_clock_ns() - start;
+	} while (elapsed < (uint64_t)RUN_MS * NSEC_PER_MSEC);
+
+	return (uint32_t)((uint64_t)i * NSEC_PER_SEC / elapsed);
+}
+
+static struct ndef_builder patch_msg;
+
+static int describe_full(int records)
+{
+	nfc_ndef_msg_clear(&NFC_NDEF_MSG(full_msg));
+
+	int ret = nfc_ndef_msg_record_add(&NFC_NDEF_MSG(full_msg),
+					  &NFC_NDEF_TEXT_RECORD_DESC(counter_rec));
+	for (int i = 1; i < records && ret == 0; i++)
+	{
+		ret = nfc_ndef_msg_record_add(&NFC_NDEF_MSG(full_msg),
+					      &NFC_NDEF_TEXT_RECORD_DESC(static_rec));
+	}
+	return ret;
+}
+
+static void patch_update(uint32_t i, int records)
+{
+	char text[COUNTER_TEXT_MAX + 1];
+	int len = snprintk(text, sizeof(text), "%u", i);
+
+	ndef_builder_set_text(&patch_msg, 0, text, len);
+}
+
+static void full_update(uint32_t i, int records)
+{
+	struct nfc_ndef_text_rec_payload_desc *counter =
+		NFC_NDEF_TEXT_RECORD_DESC(counter_rec).payload_descriptor;
+
+	counter->data_len = snprintk((char *)counter_text, sizeof(counter_text), "%u", i);
+	full_len = sizeof(full_buf);
+	nfc_ndef_msg_encode(&NFC_NDEF_MSG(full_msg), full_buf, &full_len);
+}
+
+/* Same records: TNF, type, ID and payload, whatever the record format */
+static bool same_records(const uint8_t *a, size_t a_len, const uint8_t *b, size_t b_len)
+{
+	struct ndef_parser pa, pb;
+	struct ndef_record ra, rb;
+	int ret_a, ret_b;
+
+	ndef_parser_init(&pa, a, a_len);
+	ndef_parser_init(&pb, b, b_len);
+
+	do
+	{
+		ret_a = ndef_parser_next(&pa, &ra);
+		ret_b = ndef_parser_next(&pb, &rb);
+		if (ret_a != ret_b || ret_a < 0)
+		{
+			return false;
+		}
+		if (ret_a == 1 &&
+		    (ra.tnf != rb.tnf || ra.type_len != rb.type_len || ra.id_len != rb.id_len ||
+		     ra.payload_len != rb.payload_len || memcmp(ra.type, rb.type, ra.type_len) != 0 ||
+		     memcmp(ra.id, rb.id, ra.id_len) != 0 ||
+		     memcmp(ra.payload, rb.payload, ra.payload_len) != 0))
+		{
+			return false;
+		}
+	} while (ret_a == 1);
+
+	return true;
+}
+
+int main(void)
+{
+	printk("NDEF update benchmark: %d ms per run\n", RUN_MS);
+
+	for (size_t r = 0; r < ARRAY_SIZE(record_counts); r++)
+	{
+		int records = record_counts[r];
+
+		build_patch(&patch_msg, patch_buf, records, "0");
+		describe_full(records);
+		uint32_t patch_per_sec = run(patch_update, records);
+		uint32_t full_per_sec = run(full_update, records);
+
+		/* Both ways must end up with the same records */
+		full_update(12345, records);
+		patch_update(12345, records);
+		bool match = same_records(patch_buf, ndef_builder_len(&patch_msg), full_buf, full_len);
+
+		printk("{\"records\":%d,\"msg_bytes\":%u,\"ncs_bytes\":%u,\"patch_per_sec\":%u,"
+		       "\"full_per_sec\":%u,\"match\":%s}\n",
+		       records, (uint32_t)ndef_builder_len(&patch_msg), full_len, patch_per_sec,
+		       full_per_sec, match ? "true" : "false");
+	}
+
+	printk("NDEF update benchmark done\n");
+	return 0;
+}
@@ -0,0 +1,259 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/printk.h>
+#include <string.h>
+
+#include "bench_clock.h"
+#include "ndef_builder.h"
+#include "t4t_sim.h"
+
+/* Built instead of main.c with overlay-apdu-bench.conf, runs on native_sim
+ * without the NFC hardware. Plays a reader against the T4T stand-in in
+ * t4t_sim.c: it reads MLe/MLc off the CC file, then writes a message that
+ * fills the whole CONFIG_APP_NFC_MEM_SIZE NDEF file and reads it back, the
+ * way phones do (NLEN cleared, data, NLEN set), with transfers split into
+ * chunks of 16 to 255 bytes. Reports kilobytes per second of the NDEF file
+ * handling for each chunk size and the APDUs a transfer takes, which is
+ * what dominates on the air, where every APDU costs a frame exchange.
+ */
+
+#define RUN_MS 500
+#define NLEN_SIZE 2
+#define CC_LEN 15
+#define MIME_TYPE "application/octet-stream"
+
+static const size_t chunk_sizes[] = {16, 32, 64, 128, 255};
+
+/* Tag side */
+static uint8_t nfc_mem[CONFIG_APP_NFC_MEM_SIZE];
+static size_t updated_nlen;
+
+/* Reader side */
+static uint8_t payload[CONFIG_APP_NFC_MEM_SIZE];
+static uint8_t msg_buf[CONFIG_APP_NFC_MEM_SIZE];
+static uint8_t readback[CONFIG_APP_NFC_MEM_SIZE];
+static uint8_t capdu[6 + T4T_SIM_MLC];
+static uint8_t rapdu[T4T_SIM_MLE + 2];
+static size_t mle;
+static size_t mlc;
+static uint32_t apdus;
+
+static void on_updated(size_t nlen)
+{
+	updated_nlen = nlen;
+}
+
+/* Sends the C-APDU, returns the status word and the response data length */
+static uint16_t transceive(size_t len, size_t *data_len)
+{
+	size_t rlen = t4t_sim_apdu(capdu, len, rapdu);
+
+	apdus++;
+	if (data_len)
+	{
+		*data_len = rlen - 2;
+	}
+	return sys_get_be16(&rapdu[rlen - 2]);
+}
+
+static uint16_t select_apdu(uint8_t p1, uint8_t p2, const uint8_t *data, uint8_t lc)
+{
+	capdu[0] = 0x00;
+	capdu[1] = 0xA4;
+	capdu[2] = p1;
+	capdu[3] = p2;
+	capdu[4] = lc;
+	memcpy(&capdu[5], data, lc);
+	return transceive(5 + lc, NULL);
+}
+
+static uint16_t select_file(uint16_t id)
+{
+	uint8_t data[2];
+
+	sys_put_be16(id, data);
+	return select_apdu(0x00, 0x0C, data, sizeof(data));
+}
+
+static uint16_t read_binary(uint16_t offset, uint8_t le, uint8_t *dst, size_t *len)
+{
+	capdu[0] = 0x00;
+	capdu[1] = 0xB0;
+	sys_put_be16(offset, &capdu[2]);
+	capdu[4] = le;
+
+	uint16_t sw = transceive(5, len);
+	memcpy(dst, rapdu, *len);
+	return sw;
+}
+
+static uint16_t update_binary(uint16_t offset, const uint8_t *src, uint8_t lc)
+{
+	capdu[0] = 0x00;
+	capdu[1] = 0xD6;
+	sys_put_be16(offset, &capdu[2]);
+	capdu[4] = lc;
+	memcpy(&capdu[5], src, lc);
+	return transceive(5 + lc, NULL);
+}
+
+/* NDEF application and CC file, leaves the NDEF file selected */
+static int reader_connect(void)
+{
+	static const uint8_t aid[] = {0xD2, 0x76, 0x00, 0x00, 0x85, 0x01, 0x01};
+	uint8_t cc[CC_LEN];
+	size_t len;
+
+	if (select_apdu(0x04, 0x00, aid, sizeof(aid)) != T4T_SW_OK ||
+		select_file(0xE103) != T4T_SW_OK ||
+		read_binary(0, CC_LEN, cc, &len) != T4T_SW_OK || len != CC_LEN)
+	{
+		return -EIO;
+	}
+
+	mle = sys_get_be16(&cc[3]);
+	mlc = sys_get_be16(&cc[5]);
+	return select_file(sys_get_be16(&cc[9])) == T4T_SW_OK ? 0 : -EIO;
+}
+
+static int write_message(const uint8_t *msg, size_t len, size_t chunk)
+{
+	uint8_t nlen[NLEN_SIZE] = {0};
+
+	if (update_binary(0, nlen, NLEN_SIZE) != T4T_SW_OK)
+	{
+		return -EIO;
+	}
+	for (size_t off = 0; off < len; off += chunk)
+	{
+		size_t n = MIN(chunk, len - off);
+		if (update_binary(NLEN_SIZE + off, &msg[off], n) != T4T_SW_OK)
+		{
+			return -EIO;
+		}
+	}
+	sys_put_be16(len, nlen);
+	return update_binary(0, nlen, NLEN_SIZE) == T4T_SW_OK ? 0 : -EIO;
+}
+
+/* Returns the message length */
+static int read_message(uint8_t *dst, size_t chunk)
+{
+	uint8_t nlen[NLEN_SIZE];
+	size_t len;
+
+	if (read_binary(0, NLEN_SIZE, nlen, &len) != T4T_SW_OK || len != NLEN_SIZE)
+	{
+		return -EIO;
+	}
+
+	size_t total = sys_get_be16(nlen);
+	for (size_t off = 0; off < total; off += len)
+	{
+		if (read_binary(NLEN_SIZE + off, MIN(chunk, total - off), &dst[off], &len) !=
+				T4T_SW_OK ||
+			len == 0)
+		{
+			return -EIO;
+		}
+	}
+	return total;
+}
+
+/* One MIME record filling the message part of the NDEF file */
+static int build_message(void)
+{
+	struct ndef_builder msg;
+	size_t room = sizeof(nfc_mem) - NLEN_SIZE;
+	size_t type_len = sizeof(MIME_TYPE) - 1;
+
+	/* Header, type length, 1-byte payload length, type */
+	size_t short_hdr = 3 + type_len;
+	if (room <= short_hdr)
+	{
+		return -ENOMEM;
+	}
+
+	size_t len = room - short_hdr;
+	if (len > 255)
+	{
+		/* Long record, the payload length takes 3 more bytes */
+		len = MAX(room - short_hdr - 3, 255);
+	}
+
+	for (size_t i = 0; i < len; i++)
+	{
+		payload[i] = (uint8_t)(i * 7);
+	}
+
+	ndef_builder_init(&msg, msg_buf, sizeof(msg_buf), false);
+	int ret = ndef_builder_add(&msg, NDEF_TNF_MIME, MIME_TYPE, type_len, payload, len, len);
+	return ret < 0 ? ret : (int)ndef_builder_len(&msg);
+}
+
+int main(void)
+{
+	t4t_sim_setup(nfc_mem, sizeof(nfc_mem), on_updated);
+
+	int msg_len = build_message();
+	if (msg_len < 0)
+	{
+		printk("Error: NDEF file too small for the test record\n");
+		return -1;
+	}
+
+	if (reader_connect() < 0)
+	{
+		printk("Error: NDEF application not found\n");
+		return -1;
+	}
+
+	printk("NDEF file APDU benchmark: %u byte file, MLe %u, MLc %u, %d ms per run\n",
+		   (uint32_t)sizeof(nfc_mem), (uint32_t)mle, (uint32_t)mlc, RUN_MS);
+
+	for (size_t c = 0; c < ARRAY_SIZE(chunk_sizes); c++)
+	{
+		/* Never more than the tag published in its CC file */
+		size_t write_chunk = MIN(chunk_sizes[c], mlc);
+		size_t read_chunk = MIN(chunk_sizes[c], mle);
+		uint64_t write_bytes = 0;
+		uint64_t read_bytes = 0;
+		uint64_t start;
+		uint64_t elapsed;
+		int err = 0;
+
+		start = bench_clock_ns();
+		do
+		{
+			apdus = 0;
+			err |= write_message(msg_buf, msg_len, write_chunk);
+			write_bytes += msg_len;
+			elapsed = bench_clock_ns() - start;
+		} while (elapsed < (uint64_t)RUN_MS * NSEC_PER_MSEC);
+		uint32_t write_kbps = (uint32_t)(write_bytes * NSEC_PER_SEC / elapsed / 1000);
+		uint32_t write_apdus = apdus;
+
+		start = bench_clock_ns();
+		do
+		{
+			apdus = 0;
+			memset(readback, 0, msg_len);
+			err |= read_message(readback, read_chunk) != msg_len;
+			read_bytes += msg_len;
+			elapsed = bench_clock_ns() - start;
+		} while (elapsed < (uint64_t)RUN_MS * NSEC_PER_MSEC);
+		uint32_t read_kbps = (uint32_t)(read_bytes * NSEC_PER_SEC / elapsed / 1000);
+		uint32_t read_apdus = apdus;
+
+		bool match = !err && updated_nlen == (size_t)msg_len &&
+					 memcmp(readback, msg_buf, msg_len) == 0;
+
+		printk("{\"file_bytes\":%u,\"msg_bytes\":%d,\"chunk\":%u,\"write_apdus\":%u,"
+			   "\"read_apdus\":%u,\"write_kB_per_sec\":%u,\"read_kB_per_sec\":%u,\"match\":%s}\n",
+			   (uint32_t)sizeof(nfc_mem), msg_len, (uint32_t)write_chunk, write_apdus,
+			   read_apdus, write_kbps, read_kbps, match ? "true" : "false");
+	}
+
+	printk("NDEF file APDU benchmark done\n");
+	return 0;
+}
@@ -0,0 +1,210 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <string.h>
+
+#include <nfc/ndef/msg.h>
+#include <nfc/ndef/record.h>
+#include <nfc/t4t/ndef_file.h>
+
+#include "bench_clock.h"
+#include "ndef_parse.h"
+
+/* Built instead of main.c with overlay-codec-bench.conf, runs on native_sim
+ * without the NFC hardware. Encodes T4T NDEF files of 1 to 32 MIME records
+ * with nfc_ndef_msg_encode() and nfc_t4t_ndef_file_encode(), like
+ * create_text_payload() in main.c, and decodes them again with
+ * ../common/ndef_parse.c, the parser that handles reader-written data.
+ * Payloads cycle through 8, 60, 250 and 400 bytes, so messages mix short
+ * and long records. Then replays mutated messages through the fuzz
+ * harness in ../common/ndef_parse_fuzz.c.
+ */
+
+#define RUN_MS 300
+#define CHECK_EVERY 16 /* iterations between clock checks */
+#define MAX_RECORDS 32
+#define FILE_SIZE 8192
+#define FUZZ_INPUTS 100000
+#define FUZZ_RECORDS 8
+#define MIME_TYPE "application/octet-stream"
+
+static const uint32_t payload_sizes[] = {8, 60, 250, 400};
+static const int record_counts[] = {1, 2, 4, 8, 16, 32};
+
+static uint8_t payload[400];
+static uint8_t file_buf[FILE_SIZE];
+static uint8_t fuzz_buf[FILE_SIZE];
+static uint32_t file_len;
+
+static struct nfc_ndef_bin_payload_desc payload_descs[MAX_RECORDS];
+static struct nfc_ndef_record_desc record_descs[MAX_RECORDS];
+NFC_NDEF_MSG_DEF(bench_msg, MAX_RECORDS);
+
+static uint32_t payload_size(int i)
+{
+	return payload_sizes[i % ARRAY_SIZE(payload_sizes)];
+}
+
+static void setup_message(int records)
+{
+	nfc_ndef_msg_clear(&NFC_NDEF_MSG(bench_msg));
+
+	for (int i = 0; i < records; i++)
+	{
+		payload_descs[i].payload = payload;
+		payload_descs[i].payload_length = payload_size(i);
+
+		record_descs[i] = (struct nfc_ndef_record_desc){
+			.tnf = TNF_MEDIA_TYPE,
+			.type_length = sizeof(MIME_TYPE) - 1,
+			.type = (const uint8_t *)MIME_TYPE,
+			.payload_constructor = (payload_constructor_t)nfc_ndef_bin_payload_memcopy,
+			.payload_descriptor = &payload_descs[i],
+		};
+		nfc_ndef_msg_record_add(&NFC_NDEF_MSG(bench_msg), &record_descs[i]);
+	}
+}
+
+static int encode(int records)
+{
+	uint32_t used = nfc_t4t_ndef_file_msg_size_get(sizeof(file_buf));
+	int err = nfc_ndef_msg_encode(&NFC_NDEF_MSG(bench_msg), nfc_t4t_ndef_file_msg_get(file_buf),
+								  &used);
+	if (err < 0)
+	{
+		return err;
+	}
+
+	err = nfc_t4t_ndef_file_encode(file_buf, &used);
+	file_len = used;
+	return err;
+}
+
+/* Returns the number of records, or the parser's error */
+static int decode(int records)
+{
+	struct ndef_parser parser;
+	struct ndef_record rec;
+	int count = 0;
+	int ret;
+
+	ndef_parser_init(&parser, nfc_t4t_ndef_file_msg_get(file_buf),
+					 nfc_t4t_ndef_file_msg_size_get(file_len));
+	while ((ret = ndef_parser_next(&parser, &rec)) == 1)
+	{
+		if (rec.payload_len != payload_size(count))
+		{
+			return -EBADMSG;
+		}
+		count++;
+	}
+	return ret < 0 ? ret : count;
+}
+
+/* Runs 'fn' for RUN_MS, returns calls per second */
+static uint32_t run(int (*fn)(int records), int records)
+{
+	uint32_t i = 0;
+	uint64_t start = bench_clock_ns();
+	uint64_t elapsed;
+
+	do
+	{
+		for (int n = 0; n < CHECK_EVERY; n++, i++)
+		{
+			fn(records);
+		}
+		elapsed = bench_clock_ns() - start;
+	} while (elapsed < (uint64_t)RUN_MS * NSEC_PER_MSEC);
+
+	return (uint32_t)((uint64_t)i * NSEC_PER_SEC / elapsed);
+}
+
+/* xorshift32, the same inputs on every run */
+static uint32_t rand_next(uint32_t *state)
+{
+	uint32_t x = *state;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+	return x;
+}
+
+/* Flips a few bytes of a valid message and sometimes truncates it */
+static void fuzz_replay(void)
+{
+	const uint8_t *msg = nfc_t4t_ndef_file_msg_get(file_buf);
+	uint32_t len = nfc_t4t_ndef_file_msg_size_get(file_len);
+	uint32_t state = 0x2545F491;
+	uint32_t accepted = 0;
+	uint32_t rejected = 0;
+
+	for (int i = 0; i < FUZZ_INPUTS; i++)
+	{
+		uint32_t n = len;
+		memcpy(fuzz_buf, msg, len);
+
+		for (uint32_t flips = 1 + rand_next(&state) % 4; flips > 0; flips--)
+		{
+			fuzz_buf[rand_next(&state) % len] = (uint8_t)rand_next(&state);
+		}
+		if (rand_next(&state) % 4 == 0)
+		{
+			n = rand_next(&state) % len;
+		}
+
+		if (ndef_parse_fuzz_one(fuzz_buf, n) >= 0)
+		{
+			accepted++;
+		}
+		else
+		{
+			rejected++;
+		}
+	}
+
+	printk("{\"fuzz_inputs\":%d,\"accepted\":%u,\"rejected\":%u}\n", FUZZ_INPUTS, accepted,
+		   rejected);
+}
+
+int main(void)
+{
+	for (size_t i = 0; i < sizeof(payload); i++)
+	{
+		payload[i] = (uint8_t)i;
+	}
+
+	printk("NDEF codec benchmark: %d ms per run\n", RUN_MS);
+
+	for (size_t r = 0; r < ARRAY_SIZE(record_counts); r++)
+	{
+		int records = record_counts[r];
+
+		setup_message(records);
+		if (encode(records) < 0)
+		{
+			printk("Error: encoding %d records failed\n", records);
+			return -1;
+		}
+
+		bool match = decode(records) == records;
+		uint32_t encode_per_sec = run(encode, records);
+		uint32_t decode_per_sec = run(decode, records);
+
+		printk("{\"records\":%d,\"file_bytes\":%u,\"encode_per_sec\":%u,"
+			   "\"encode_kB_per_sec\":%u,\"decode_per_sec\":%u,\"decode_kB_per_sec\":%u,"
+			   "\"match\":%s}\n",
+			   records, file_len, encode_per_sec,
+			   (uint32_t)((uint64_t)encode_per_sec * file_len / 1000), decode_per_sec,
+			   (uint32_t)((uint64_t)decode_per_sec * file_len / 1000),
+			   match ? "true" : "false");
+	}
+
+	setup_message(FUZZ_RECORDS);
+	encode(FUZZ_RECORDS);
+	fuzz_replay();
+
+	printk("NDEF codec benchmark done\n");
+	return 0;
+}
@@ -8,9 +8,90 @@
 
 #include <string.h>
 
-#define NFC_MEM_SIZE 256
+#include "ndef_rx.h"
+#include "ndef_store.h"
+
+/* NDEF file with its NLEN field, the library serves it in place. Sized with
+ * CONFIG_APP_NFC_MEM_SIZE; readers split longer messages over several
+ * UPDATE BINARY commands, up to the APDU size in the CC file.
+ */
+#define NFC_MEM_SIZE CONFIG_APP_NFC_MEM_SIZE
 static uint8_t nfc_mem[NFC_MEM_SIZE];
 
+/* Per reader session, reported when the reader leaves. The worst
+ * tag_event_handler() run over all events.
+ */
+static int64_t field_on_ms;
+static uint32_t handler_max_cycles;
+
+static void report_work_handler(struct k_work *work);
+static K_WORK_DEFINE(report_work, report_work_handler);
+
+/* Consumers, called on the ndef_rx workqueue with each written record */
+static void on_text_record(const struct ndef_record *rec, void *user_data)
+{
+	if (rec->payload_len < 1)
+	{
+		return;
+	}
+
+	/* Status byte, language code, then the text */
+	uint8_t lang_len = rec->payload[0] & 0x3F;
+	if (1U + lang_len > rec->payload_len)
+	{
+		return;
+	}
+
+	printk("Text (%.*s): %.*s\n", lang_len, (const char *)&rec->payload[1],
+	       (int)(rec->payload_len - 1 - lang_len), (const char *)&rec->payload[1 + lang_len]);
+}
+
+static void on_mime_record(const struct ndef_record *rec, void *user_data)
+{
+	printk("MIME %.*s, %u bytes\n", rec->type_len, (const char *)rec->type, rec->payload_len);
+}
+
+static struct ndef_rx_consumer text_consumer = {
+	.tnf = NDEF_TNF_WELL_KNOWN,
+	.type = "T",
+	.handler = on_text_record,
+};
+
+static struct ndef_rx_consumer mime_consumer = {
+	.tnf = NDEF_TNF_MIME,
+	.handler = on_mime_record,
+};
+
+static void report_work_handler(struct k_work *work)
+{
+	struct ndef_rx_stats stats;
+	uint32_t ms = MAX((uint32_t)(k_uptime_get() - field_on_ms), 1);
+
+	ndef_rx_stats_get(&stats);
+	printk("Session: %u messages in %u ms (%u/s), %u records, %u malformed, %u dropped, "
+	       "handler max %u us, processing max %u us\n",
+	       stats.messages, ms, stats.messages * MSEC_PER_SEC / ms, stats.records,
+	       stats.malformed, stats.dropped, k_cyc_to_us_ceil32(handler_max_cycles),
+	       stats.max_process_us);
+
+	ndef_rx_stats_reset();
+	handler_max_cycles = 0;
+
+	if (!IS_ENABLED(CONFIG_APP_NDEF_STORE))
+	{
+		return;
+	}
+
+	/* Cumulative, a message is only written once the debounce time is over */
+	struct ndef_store_stats store;
+
+	ndef_store_stats_get(&store);
+	printk("Flash since boot: %u messages, %u written, %u writes avoided "
+	       "(%u coalesced, %u unchanged), write max %u us\n",
+	       store.submitted, store.writes, store.coalesced + store.unchanged,
+	       store.coalesced, store.unchanged, store.max_write_us);
+}
+
 static void tag_event_handler(void *ctx, nfc_t4t_event_t evt,
 							  const uint8_t *data, size_t len, uint32_t flags)
 {
@@ -18,23 +99,38 @@ static void tag_event_handler(void *ctx, nfc_t4t_event_t evt,
 	ARG_UNUSED(data);
 	ARG_UNUSED(flags);
 
+	uint32_t start = k_cycle_get_32();
+
 	switch (evt)
 	{
 	case NFC_T4T_EVENT_FIELD_ON:
+		field_on_ms = k_uptime_get();
 		printk("Reader present\n");
 		break;
 	case NFC_T4T_EVENT_FIELD_OFF:
 		printk("Reader removed\n");
+		k_work_submit(&report_work);
 		break;
 	case NFC_T4T_EVENT_NDEF_READ:
 		printk("Message read\n");
 		break;
 	case NFC_T4T_EVENT_NDEF_UPDATED:
-		printk("Message updated (%d bytes)\n", len);
+		/* A reader clears the length first, writes, then sets the new
+		 * length. Copy the message out and let the workqueue parse it,
+		 * and queue it for flash.
+		 */
+		if (len > 0)
+		{
+			ndef_rx_submit(nfc_t4t_ndef_file_msg_get(nfc_mem), len);
+			ndef_store_submit(nfc_t4t_ndef_file_msg_get(nfc_mem), len);
+		}
 		break;
 	default:
 		break;
 	}
+
+	/* Every event counts, the printk() calls run in the same context */
+	handler_max_cycles = MAX(handler_max_cycles, k_cycle_get_32() - start);
 }
 
 static int create_text_payload(uint8_t *buf, uint32_t *len)
@@ -73,12 +169,56 @@ static int create_text_payload(uint8_t *buf, uint32_t *len)
 	return 0;
 }
 
+/* The message a reader wrote before the last reboot, if there is one */
+static int restore_payload(uint8_t *buf, uint32_t *len)
+{
+	if (!IS_ENABLED(CONFIG_APP_NDEF_STORE))
+	{
+		return -ENOTSUP;
+	}
+
+	int err = ndef_store_init();
+	if (err < 0)
+	{
+		printk("Warning: flash store unavailable (%d)\n", err);
+		return err;
+	}
+
+	int msg_len = ndef_store_restore(nfc_t4t_ndef_file_msg_get(buf),
+									 nfc_t4t_ndef_file_msg_size_get(*len));
+	if (msg_len <= 0)
+	{
+		return msg_len < 0 ? msg_len : -ENOENT;
+	}
+
+	uint32_t used = msg_len;
+	err = nfc_t4t_ndef_file_encode(buf, &used);
+	if (err < 0)
+	{
+		return err;
+	}
+
+	*len = used;
+	return 0;
+}
+
 int main(void)
 {
 	printk("NFC tag init\n");
 
+	ndef_rx_init();
+	ndef_rx_register(&text_consumer);
+	ndef_rx_register(&mime_consumer);
+
 	uint32_t ndef_len = NFC_MEM_SIZE;
-	if (create_text_payload(nfc_mem, &ndef_len) < 0)
+	if (restore_payload(nfc_mem, &ndef_len) == 0)
+	{
+		struct ndef_store_stats store;
+
+		ndef_store_stats_get(&store);
+		printk("Restored %u byte message in %u us\n", ndef_len, store.restore_us);
+	}
+	else if (create_text_payload(nfc_mem, &ndef_len) < 0)
 	{
 		printk("Error: failed to build initial message\n");
 		return -1;
@@ -0,0 +1,107 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <string.h>
+
+#include "ndef_builder.h"
+#include "ndef_store.h"
+
+/* Built instead of main.c with overlay-store-bench.conf, runs on native_sim
+ * against the flash simulator. Plays the writes a phone would make through
+ * ndef_store_submit() and reports how many reach flash:
+ *
+ * - same:     one message written in 10 separate sessions
+ * - burst:    10 different messages within the debounce time
+ * - distinct: 10 different messages in 10 separate sessions
+ *
+ * The simulated flash is kept in flash.bin, so a second run restores the
+ * last "distinct" message of the first one at boot.
+ */
+
+#define MSG_SIZE 64
+#define WRITES 10
+#define BURST_GAP K_MSEC(10)
+
+static uint8_t msg_buf[MSG_SIZE];
+static uint8_t restore_buf[CONFIG_APP_NDEF_STORE_MAX_SIZE];
+
+static size_t text_message(const char *text)
+{
+	struct ndef_builder msg;
+
+	ndef_builder_init(&msg, msg_buf, sizeof(msg_buf), false);
+	ndef_builder_add_text(&msg, "en", text, strlen(text));
+	return ndef_builder_len(&msg);
+}
+
+/* Leaves the message in msg_buf, returns its length */
+static size_t submit_text(const char *fmt, int i)
+{
+	char text[24];
+
+	snprintk(text, sizeof(text), fmt, i);
+	size_t len = text_message(text);
+	ndef_store_submit(msg_buf, len);
+	return len;
+}
+
+static void report(const char *scenario)
+{
+	struct ndef_store_stats stats;
+
+	ndef_store_stats_get(&stats);
+	printk("{\"scenario\":\"%s\",\"submitted\":%u,\"writes\":%u,\"avoided\":%u,"
+	       "\"coalesced\":%u,\"unchanged\":%u,\"errors\":%u,\"max_write_us\":%u}\n",
+	       scenario, stats.submitted, stats.writes, stats.coalesced + stats.unchanged,
+	       stats.coalesced, stats.unchanged, stats.errors, stats.max_write_us);
+	ndef_store_stats_reset();
+}
+
+int main(void)
+{
+	struct ndef_store_stats stats;
+
+	if (ndef_store_init() < 0)
+	{
+		printk("Error: flash store unavailable\n");
+		return -1;
+	}
+
+	int len = ndef_store_restore(restore_buf, sizeof(restore_buf));
+	ndef_store_stats_get(&stats);
+	printk("{\"boot_restore_bytes\":%d,\"restore_us\":%u}\n", len, stats.restore_us);
+	ndef_store_stats_reset();
+
+	for (int i = 0; i < WRITES; i++)
+	{
+		submit_text("same", i);
+		ndef_store_flush();
+	}
+	report("same");
+
+	/* Left to the debounce timer rather than flushed */
+	for (int i = 0; i < WRITES; i++)
+	{
+		submit_text("burst %d", i);
+		k_sleep(BURST_GAP);
+	}
+	k_sleep(K_MSEC(2 * CONFIG_APP_NDEF_STORE_DEBOUNCE_MS));
+	report("burst");
+
+	size_t last_len = 0;
+	for (int i = 0; i < WRITES; i++)
+	{
+		last_len = submit_text("distinct %d", i);
+		ndef_store_flush();
+	}
+	report("distinct");
+
+	/* What the next boot will find */
+	len = ndef_store_restore(restore_buf, sizeof(restore_buf));
+	ndef_store_stats_get(&stats);
+	bool match = len == (int)last_len && memcmp(restore_buf, msg_buf, last_len) == 0;
+	printk("{\"restore_bytes\":%d,\"restore_us\":%u,\"match\":%s}\n", len, stats.restore_us,
+	       match ? "true" : "false");
+
+	printk("NDEF store benchmark done\n");
+	return 0;
+}
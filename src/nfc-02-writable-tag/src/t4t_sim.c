@@ -0,0 +1,210 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+#include <string.h>
+
+#include "t4t_sim.h"
+
+#define CLA 0x00
+#define INS_SELECT 0xA4
+#define INS_READ_BINARY 0xB0
+#define INS_UPDATE_BINARY 0xD6
+
+#define SELECT_BY_NAME 0x04
+#define SELECT_BY_ID 0x00
+#define SELECT_FIRST_ONLY 0x0C
+
+#define CC_FILE_ID 0xE103
+#define NDEF_FILE_ID 0xE104
+#define CC_LEN 15
+#define NLEN_SIZE 2
+
+static const uint8_t ndef_aid[] = {0xD2, 0x76, 0x00, 0x00, 0x85, 0x01, 0x01};
+
+enum sim_file
+{
+	FILE_NONE,
+	FILE_CC,
+	FILE_NDEF,
+};
+
+static struct
+{
+	uint8_t *file;
+	size_t size;
+	t4t_sim_updated_t updated;
+	bool app_selected;
+	enum sim_file selected;
+	uint8_t cc[CC_LEN];
+} sim;
+
+void t4t_sim_setup(uint8_t *file, size_t size, t4t_sim_updated_t updated)
+{
+	sim.file = file;
+	sim.size = size;
+	sim.updated = updated;
+	sim.app_selected = false;
+	sim.selected = FILE_NONE;
+
+	/* CCLEN, mapping version 2.0, MLe, MLc, then the NDEF File Control
+	 * TLV: file ID, maximum size, read and write access granted
+	 */
+	uint8_t *cc = sim.cc;
+	sys_put_be16(CC_LEN, &cc[0]);
+	cc[2] = 0x20;
+	sys_put_be16(T4T_SIM_MLE, &cc[3]);
+	sys_put_be16(T4T_SIM_MLC, &cc[5]);
+	cc[7] = 0x04;
+	cc[8] = 0x06;
+	sys_put_be16(NDEF_FILE_ID, &cc[9]);
+	sys_put_be16((uint16_t)size, &cc[11]);
+	cc[13] = 0x00;
+	cc[14] = 0x00;
+}
+
+static size_t status(uint8_t *rapdu, size_t data_len, uint16_t sw)
+{
+	sys_put_be16(sw, &rapdu[data_len]);
+	return data_len + 2;
+}
+
+static uint16_t select_file(uint8_t p1, uint8_t p2, const uint8_t *data, uint8_t lc)
+{
+	if (p1 == SELECT_BY_NAME)
+	{
+		if (lc != sizeof(ndef_aid) || memcmp(data, ndef_aid, lc) != 0)
+		{
+			return T4T_SW_NOT_FOUND;
+		}
+		sim.app_selected = true;
+		sim.selected = FILE_NONE;
+		return T4T_SW_OK;
+	}
+
+	if (p1 != SELECT_BY_ID || p2 != SELECT_FIRST_ONLY)
+	{
+		return T4T_SW_WRONG_P1P2;
+	}
+	if (!sim.app_selected || lc != 2)
+	{
+		return T4T_SW_NOT_FOUND;
+	}
+
+	switch (sys_get_be16(data))
+	{
+	case CC_FILE_ID:
+		sim.selected = FILE_CC;
+		return T4T_SW_OK;
+	case NDEF_FILE_ID:
+		sim.selected = FILE_NDEF;
+		return T4T_SW_OK;
+	default:
+		return T4T_SW_NOT_FOUND;
+	}
+}
+
+static size_t read_binary(uint16_t offset, size_t le, uint8_t *rapdu)
+{
+	const uint8_t *file = sim.selected == FILE_CC ? sim.cc : sim.file;
+	size_t size = sim.selected == FILE_CC ? sizeof(sim.cc) : sim.size;
+
+	if (sim.selected == FILE_NONE)
+	{
+		return status(rapdu, 0, T4T_SW_NOT_ALLOWED);
+	}
+	if (le > T4T_SIM_MLE)
+	{
+		return status(rapdu, 0, T4T_SW_WRONG_LENGTH);
+	}
+	if (offset >= size)
+	{
+		return status(rapdu, 0, T4T_SW_WRONG_OFFSET);
+	}
+
+	size_t n = MIN(le, size - offset);
+	memcpy(rapdu, &file[offset], n);
+	return status(rapdu, n, T4T_SW_OK);
+}
+
+static uint16_t update_binary(uint16_t offset, const uint8_t *data, size_t lc)
+{
+	if (sim.selected == FILE_NONE)
+	{
+		return T4T_SW_NOT_ALLOWED;
+	}
+	if (sim.selected == FILE_CC)
+	{
+		return T4T_SW_SECURITY;
+	}
+	if (lc > T4T_SIM_MLC)
+	{
+		return T4T_SW_WRONG_LENGTH;
+	}
+	if ((size_t)offset + lc > sim.size)
+	{
+		return T4T_SW_WRONG_OFFSET;
+	}
+
+	memcpy(&sim.file[offset], data, lc);
+
+	/* Readers write NLEN on its own, 0 before the message and the real
+	 * length after it
+	 */
+	if (offset < NLEN_SIZE && sim.updated)
+	{
+		sim.updated(sys_get_be16(sim.file));
+	}
+	return T4T_SW_OK;
+}
+
+size_t t4t_sim_apdu(const uint8_t *capdu, size_t len, uint8_t *rapdu)
+{
+	if (len < 4)
+	{
+		return status(rapdu, 0, T4T_SW_WRONG_LENGTH);
+	}
+	if (capdu[0] != CLA)
+	{
+		return status(rapdu, 0, T4T_SW_CLA_NOT_SUPPORTED);
+	}
+
+	uint8_t ins = capdu[1];
+	uint8_t p1 = capdu[2];
+	uint8_t p2 = capdu[3];
+
+	if (ins == INS_READ_BINARY)
+	{
+		/* Case 2: the fifth byte is Le, 0 meaning 256 */
+		if (len != 5)
+		{
+			return status(rapdu, 0, T4T_SW_WRONG_LENGTH);
+		}
+		if (p1 & 0x80)
+		{
+			return status(rapdu, 0, T4T_SW_WRONG_P1P2);
+		}
+		return read_binary(sys_get_be16(&capdu[2]), capdu[4] ? capdu[4] : 256, rapdu);
+	}
+
+	/* Case 3 or 4: Lc, then Lc bytes of data, then an optional Le */
+	if (len < 5 || len < 5U + capdu[4] || len > 6U + capdu[4])
+	{
+		return status(rapdu, 0, T4T_SW_WRONG_LENGTH);
+	}
+
+	uint8_t lc = capdu[4];
+	const uint8_t *data = &capdu[5];
+
+	switch (ins)
+	{
+	case INS_SELECT:
+		return status(rapdu, 0, select_file(p1, p2, data, lc));
+	case INS_UPDATE_BINARY:
+		if (p1 & 0x80)
+		{
+			return status(rapdu, 0, T4T_SW_WRONG_P1P2);
+		}
+		return status(rapdu, 0, update_binary(sys_get_be16(&capdu[2]), data, lc));
+	default:
+		return status(rapdu, 0, T4T_SW_INS_NOT_SUPPORTED);
+	}
+}
@@ -0,0 +1,43 @@
+#ifndef T4T_SIM_H_
+#define T4T_SIM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Stand-in for the Type 4 Tag library's NDEF application on native_sim,
+ * used by apdu_bench.c. It answers the C-APDUs a reader sends (SELECT of
+ * the NDEF application, the CC file and the NDEF file, READ BINARY and
+ * UPDATE BINARY) from the same kind of NDEF file buffer main.c hands to
+ * nfc_t4t_ndef_rwpayload_set(), and calls 'updated' with the new NLEN
+ * whenever a write touches it, like NFC_T4T_EVENT_NDEF_UPDATED.
+ *
+ * Short APDUs only. MLe and MLc, the largest response and command data the
+ * tag accepts, are published in the CC file like the library does, and a
+ * reader has to read them from there and split its transfers accordingly.
+ */
+
+#define T4T_SIM_MLE 255
+#define T4T_SIM_MLC 255
+
+/* Status words */
+#define T4T_SW_OK 0x9000
+#define T4T_SW_WRONG_LENGTH 0x6700
+#define T4T_SW_SECURITY 0x6982
+#define T4T_SW_NOT_ALLOWED 0x6986
+#define T4T_SW_NOT_FOUND 0x6A82
+#define T4T_SW_WRONG_P1P2 0x6A86
+#define T4T_SW_WRONG_OFFSET 0x6B00
+#define T4T_SW_INS_NOT_SUPPORTED 0x6D00
+#define T4T_SW_CLA_NOT_SUPPORTED 0x6E00
+
+typedef void (*t4t_sim_updated_t)(size_t nlen);
+
+void t4t_sim_setup(uint8_t *file, size_t size, t4t_sim_updated_t updated);
+
+/* Processes one C-APDU. The R-APDU, response data then status word, goes
+ * to 'rapdu', which needs room for T4T_SIM_MLE + 2 bytes. Returns its
+ * length.
+ */
+size_t t4t_sim_apdu(const uint8_t *capdu, size_t len, uint8_t *rapdu);
+
+#endif /* T4T_SIM_H_ */
@@ -0,0 +1,251 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/bluetooth/addr.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+#include <string.h>
+
+#include "le_oob_rec.h"
+#include "ndef_parse.h"
+#include "oob_file.h"
+
+LOG_MODULE_REGISTER(central, LOG_LEVEL_INF);
+
+/* Built instead of main.c with overlay-bsim-central.conf: the phone, as a
+ * second BabbleSim device. Every CONFIG_APP_OOB_SIM_TAP_MS it "taps" the
+ * tag, i.e. reads the NDEF message the peripheral wrote to
+ * CONFIG_APP_OOB_SIM_FILE, connects to the address in the OOB record and
+ * pairs. If the record carries LE Secure Connections values, pairing uses
+ * the OOB method; if not, the peripheral displays its passkey and this
+ * side enters it CONFIG_APP_PASSKEY_ENTRY_MS later, standing in for the
+ * operator. One JSON line per run, times in simulated milliseconds:
+ * tap to connected, connected to encrypted, and tap to encrypted.
+ */
+
+#define CONNECT_TIMEOUT K_SECONDS(10)
+#define SECURITY_TIMEOUT K_MSEC(CONFIG_APP_PASSKEY_ENTRY_MS + 10000)
+#define MSG_MAX 256
+
+static struct bt_conn *conn;
+static struct bt_le_oob_sc_data oob_remote;
+static int64_t encrypted_ms;
+static bt_security_t sec_level;
+static bool sec_ok;
+
+static K_SEM_DEFINE(connected_sem, 0, 1);
+static K_SEM_DEFINE(security_sem, 0, 1);
+static K_SEM_DEFINE(disconnected_sem, 0, 1);
+
+static void passkey_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(passkey_work, passkey_work_handler);
+
+/* Reads the tag, returns 0 with the OOB record in 'rec' */
+static int tap(struct le_oob_rec *rec)
+{
+	static uint8_t msg[MSG_MAX];
+	struct ndef_parser parser;
+	struct ndef_record ndef;
+	int ret;
+
+	int len = oob_file_read(CONFIG_APP_OOB_SIM_FILE, msg, sizeof(msg));
+	if (len < 0)
+	{
+		return len;
+	}
+
+	ndef_parser_init(&parser, msg, len);
+	while ((ret = ndef_parser_next(&parser, &ndef)) == 1)
+	{
+		if (ndef_record_is(&ndef, NDEF_TNF_MIME, LE_OOB_REC_TYPE))
+		{
+			return le_oob_rec_decode(rec, ndef.payload, ndef.payload_len);
+		}
+	}
+	return ret < 0 ? ret : -ENOENT;
+}
+
+static void on_connected(struct bt_conn *c, uint8_t err)
+{
+	if (err)
+	{
+		LOG_ERR("Connection failed (err %u)", err);
+		bt_conn_unref(conn);
+		conn = NULL;
+	}
+	k_sem_give(&connected_sem);
+}
+
+static void on_disconnected(struct bt_conn *c, uint8_t reason)
+{
+	k_work_cancel_delayable(&passkey_work);
+	if (conn)
+	{
+		bt_conn_unref(conn);
+		conn = NULL;
+	}
+
+	/* Wake a run waiting for pairing, too */
+	k_sem_give(&security_sem);
+	k_sem_give(&disconnected_sem);
+}
+
+static void on_security_changed(struct bt_conn *c, bt_security_t level, enum bt_security_err err)
+{
+	encrypted_ms = k_uptime_get();
+	sec_level = level;
+	sec_ok = err == 0;
+	if (err)
+	{
+		LOG_WRN("Security setup failed (level %u, err %d)", level, err);
+	}
+	k_sem_give(&security_sem);
+}
+
+static struct bt_conn_cb connection_callbacks = {
+	.connected = on_connected,
+	.disconnected = on_disconnected,
+	.security_changed = on_security_changed,
+};
+
+/* We have the peripheral's values from the tag, it has none of ours */
+static void oob_data_request(struct bt_conn *c, struct bt_conn_oob_info *info)
+{
+	if (info->type == BT_CONN_OOB_LE_SC && info->lesc.oob_config == BT_CONN_OOB_REMOTE_ONLY &&
+		bt_le_oob_set_sc_data(c, NULL, &oob_remote) == 0)
+	{
+		return;
+	}
+
+	LOG_WRN("Unexpected OOB data request");
+	bt_conn_auth_cancel(c);
+}
+
+static void passkey_work_handler(struct k_work *work)
+{
+	if (conn)
+	{
+		bt_conn_auth_passkey_entry(conn, CONFIG_APP_PASSKEY);
+	}
+}
+
+static void passkey_entry(struct bt_conn *c)
+{
+	k_work_reschedule(&passkey_work, K_MSEC(CONFIG_APP_PASSKEY_ENTRY_MS));
+}
+
+static const struct bt_conn_auth_cb auth_callbacks = {
+	.oob_data_request = oob_data_request,
+	.passkey_entry = passkey_entry,
+};
+
+static int run(int n)
+{
+	struct le_oob_rec rec;
+	bt_addr_le_t peer;
+	char addr[BT_ADDR_LE_STR_LEN];
+
+	int64_t tap_ms = k_uptime_get();
+	int err = tap(&rec);
+	if (err)
+	{
+		LOG_ERR("No OOB record on the tag (err %d)", err);
+		return err;
+	}
+
+	peer.type = rec.addr_type;
+	memcpy(peer.a.val, rec.addr, sizeof(peer.a.val));
+	bt_addr_le_to_str(&peer, addr, sizeof(addr));
+	LOG_INF("Run %d: tag read, %s pairing with %s", n, rec.has_sc ? "OOB" : "passkey", addr);
+
+	/* Our pairing request announces the OOB data */
+	memcpy(oob_remote.c, rec.confirm, sizeof(oob_remote.c));
+	memcpy(oob_remote.r, rec.random, sizeof(oob_remote.r));
+	bt_le_oob_set_sc_flag(rec.has_sc);
+
+	k_sem_reset(&connected_sem);
+	k_sem_reset(&security_sem);
+	k_sem_reset(&disconnected_sem);
+
+	err = bt_conn_le_create(&peer, BT_CONN_LE_CREATE_CONN, BT_LE_CONN_PARAM_DEFAULT, &conn);
+	if (err)
+	{
+		LOG_ERR("Create connection failed (err %d)", err);
+		return err;
+	}
+
+	if (k_sem_take(&connected_sem, CONNECT_TIMEOUT) != 0 || !conn)
+	{
+		LOG_ERR("Connection timed out");
+		if (conn)
+		{
+			/* Cancels the attempt, on_connected() then drops the reference */
+			bt_conn_disconnect(conn, BT_HCI_ERR_REMOTE_USER_TERM_CONN);
+			k_sem_take(&connected_sem, CONNECT_TIMEOUT);
+		}
+		return -ETIMEDOUT;
+	}
+
+	int64_t connected_ms = k_uptime_get();
+	sec_ok = false;
+	err = bt_conn_set_security(conn, BT_SECURITY_L4);
+	if (err == 0 && k_sem_take(&security_sem, SECURITY_TIMEOUT) != 0)
+	{
+		err = -ETIMEDOUT;
+	}
+
+	if (err == 0 && sec_ok)
+	{
+		printk("{\"run\":%d,\"mode\":\"%s\",\"connect_ms\":%d,\"pair_ms\":%d,"
+			   "\"tap_to_encrypted_ms\":%d,\"level\":%u}\n",
+			   n, rec.has_sc ? "oob" : "passkey", (int)(connected_ms - tap_ms),
+			   (int)(encrypted_ms - connected_ms), (int)(encrypted_ms - tap_ms), sec_level);
+	}
+	else
+	{
+		LOG_ERR("Pairing failed (err %d)", err);
+		err = err ? err : -EACCES;
+	}
+
+	if (conn)
+	{
+		bt_conn_disconnect(conn, BT_HCI_ERR_REMOTE_USER_TERM_CONN);
+	}
+	k_sem_take(&disconnected_sem, CONNECT_TIMEOUT);
+	return err;
+}
+
+int main(void)
+{
+	int err = bt_conn_auth_cb_register(&auth_callbacks);
+	if (err)
+	{
+		LOG_ERR("Failed to register authorization callbacks (err %d)", err);
+		return -1;
+	}
+
+	err = bt_conn_cb_register(&connection_callbacks);
+	if (err)
+	{
+		LOG_ERR("Failed to register connection callbacks (err %d)", err);
+		return -1;
+	}
+
+	err = bt_enable(NULL);
+	if (err)
+	{
+		LOG_ERR("Bluetooth init failed (err %d)", err);
+		return -1;
+	}
+
+	int failed = 0;
+
+	for (int n = 1; n <= CONFIG_APP_OOB_SIM_RUNS; n++)
+	{
+		/* The peripheral writes fresh OOB values after each disconnect */
+		k_sleep(K_MSEC(CONFIG_APP_OOB_SIM_TAP_MS));
+		failed += run(n) != 0;
+	}
+
+	printk("OOB pairing simulation done: %d runs, %d failed\n", CONFIG_APP_OOB_SIM_RUNS, failed);
+	return 0;
+}
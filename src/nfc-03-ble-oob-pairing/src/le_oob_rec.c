@@ -0,0 +1,88 @@
+#include <errno.h>
+#include <string.h>
+
+#include "le_oob_rec.h"
+
+/* AD types, Bluetooth Assigned Numbers */
+#define AD_FLAGS 0x01
+#define AD_NAME_COMPLETE 0x09
+#define AD_LE_ADDRESS 0x1B
+#define AD_LE_ROLE 0x1C
+#define AD_LE_SC_CONFIRM 0x22
+#define AD_LE_SC_RANDOM 0x23
+
+int le_oob_rec_decode(struct le_oob_rec *rec, const uint8_t *buf, size_t len)
+{
+	bool has_addr = false;
+	bool has_confirm = false;
+	bool has_random = false;
+	size_t pos = 0;
+
+	memset(rec, 0, sizeof(*rec));
+
+	while (pos < len)
+	{
+		uint8_t ad_len = buf[pos];
+		if (ad_len == 0)
+		{
+			break; /* padding */
+		}
+		if (ad_len > len - pos - 1)
+		{
+			return -EBADMSG;
+		}
+
+		uint8_t type = buf[pos + 1];
+		const uint8_t *data = &buf[pos + 2];
+		uint8_t data_len = ad_len - 1;
+
+		switch (type)
+		{
+		case AD_LE_ADDRESS:
+			if (data_len == 7)
+			{
+				memcpy(rec->addr, data, 6);
+				rec->addr_type = data[6] & 0x01;
+				has_addr = true;
+			}
+			break;
+		case AD_LE_ROLE:
+			if (data_len == 1)
+			{
+				rec->role = data[0];
+			}
+			break;
+		case AD_LE_SC_CONFIRM:
+			if (data_len == 16)
+			{
+				memcpy(rec->confirm, data, 16);
+				has_confirm = true;
+			}
+			break;
+		case AD_LE_SC_RANDOM:
+			if (data_len == 16)
+			{
+				memcpy(rec->random, data, 16);
+				has_random = true;
+			}
+			break;
+		case AD_FLAGS:
+			if (data_len == 1)
+			{
+				rec->flags = data[0];
+			}
+			break;
+		case AD_NAME_COMPLETE:
+			rec->name = (const char *)data;
+			rec->name_len = data_len;
+			break;
+		default:
+			break;
+		}
+
+		pos += 1 + ad_len;
+	}
+
+	rec->has_sc = has_confirm && has_random;
+	return has_addr ? 0 : -ENOENT;
+}
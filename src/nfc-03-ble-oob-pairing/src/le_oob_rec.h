@@ -0,0 +1,45 @@
+#ifndef LE_OOB_REC_H_
+#define LE_OOB_REC_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Payload of the Bluetooth LE OOB record, the NDEF MIME record a phone
+ * reads off the tag for connection handover: a list of AD structures
+ * (length, AD type, data) with the device address, its LE role, the LE
+ * Secure Connections confirm and random values, flags and name.
+ *
+ * The tag builds it with the NCS nfc_ndef_le_oob_rec library. This is the
+ * reading side, for the simulated phone in central.c.
+ *
+ * Multi-byte values are little-endian like everywhere in AD data, which
+ * is also how Zephyr keeps them in bt_addr_t and bt_le_oob_sc_data, so
+ * they are copied as they are.
+ */
+
+#define LE_OOB_REC_TYPE "application/vnd.bluetooth.le.oob"
+
+/* LE Role AD values */
+#define LE_OOB_ROLE_PERIPHERAL_ONLY 0x00
+#define LE_OOB_ROLE_CENTRAL_ONLY 0x01
+
+struct le_oob_rec
+{
+	uint8_t addr[6];
+	uint8_t addr_type; /* BT_ADDR_LE_PUBLIC or BT_ADDR_LE_RANDOM */
+	uint8_t role;
+	uint8_t flags;
+	bool has_sc; /* confirm and random are set */
+	uint8_t confirm[16];
+	uint8_t random[16];
+	const char *name; /* not terminated, points into the payload */
+	uint8_t name_len;
+};
+
+/* Returns 0, -EBADMSG if an AD structure runs past the payload, or
+ * -ENOENT without an address. Unknown AD types are skipped.
+ */
+int le_oob_rec_decode(struct le_oob_rec *rec, const uint8_t *buf, size_t len);
+
+#endif /* LE_OOB_REC_H_ */
@@ -0,0 +1,289 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/bluetooth/addr.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/gap.h>
+
+#include <nfc/ndef/msg.h>
+#include <nfc/ndef/ch_msg.h>
+#include <nfc/ndef/le_oob_rec.h>
+
+#include <string.h>
+
+#include "tag.h"
+
+LOG_MODULE_REGISTER(main, LOG_LEVEL_INF);
+
+/* Peripheral that hands its pairing data to the phone over NFC. The tag
+ * serves a Bluetooth LE OOB record with the device address and the LE
+ * Secure Connections confirm and random values; a phone that taps it
+ * connects straight to that address and pairs with the OOB method, so
+ * nobody has to read or type a passkey. The OOB values are single use and
+ * are generated again after every connection. The message is a
+ * connection handover Handover Select record pointing to the LE OOB
+ * record, built with the NCS NDEF libraries.
+ *
+ * With CONFIG_APP_PAIRING_PASSKEY the record only carries the address and
+ * pairing falls back to the fixed passkey of ble-07-security-modes, to
+ * compare the two.
+ */
+
+#define DEVICE_NAME CONFIG_BT_DEVICE_NAME
+#define DEVICE_NAME_LEN (sizeof(DEVICE_NAME) - 1)
+
+/* About 120 bytes with the default name */
+#define NDEF_MSG_SIZE 256
+
+static const struct bt_data ad[] = {
+	BT_DATA_BYTES(BT_DATA_FLAGS, (BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR)),
+	BT_DATA(BT_DATA_NAME_COMPLETE, DEVICE_NAME, DEVICE_NAME_LEN),
+};
+
+/* Given to the stack by pointer in oob_data_request(), so it only changes
+ * once the connection is gone
+ */
+static struct bt_le_oob oob_local;
+static uint8_t msg_buf[NDEF_MSG_SIZE];
+
+/* Uptime of the last tag read and of the connection */
+static int64_t tap_ms;
+static int64_t connected_ms;
+
+static void publish_work_handler(struct k_work *work);
+static K_WORK_DEFINE(publish_work, publish_work_handler);
+
+static void on_tag_read(void)
+{
+	tap_ms = k_uptime_get();
+}
+
+/* Handover Select with one alternative carrier, the LE OOB record with
+ * ID '0'. Returns the encoded length in 'len'.
+ */
+static int build_message(uint32_t *len)
+{
+	static struct nfc_ndef_le_oob_rec_payload_desc rec_payload;
+	struct nfc_ndef_ch_msg_records ch_records;
+
+	NFC_NDEF_LE_OOB_RECORD_DESC_DEF(oob_rec, '0', &rec_payload);
+	NFC_NDEF_CH_AC_RECORD_DESC_DEF(oob_ac, NFC_AC_CPS_ACTIVE, 1, "0", 0);
+	NFC_NDEF_CH_HS_RECORD_DESC_DEF(hs_rec, NFC_NDEF_CH_MSG_MAJOR_VER, NFC_NDEF_CH_MSG_MINOR_VER,
+								   1);
+	NFC_NDEF_MSG_DEF(hs_msg, 2);
+
+	memset(&rec_payload, 0, sizeof(rec_payload));
+	rec_payload.addr = &oob_local.addr;
+	rec_payload.le_role = NFC_NDEF_LE_OOB_REC_LE_ROLE(NFC_NDEF_LE_OOB_REC_LE_ROLE_PERIPH_ONLY);
+	rec_payload.flags = NFC_NDEF_LE_OOB_REC_FLAGS(BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR);
+	rec_payload.local_name = DEVICE_NAME;
+	if (!IS_ENABLED(CONFIG_APP_PAIRING_PASSKEY))
+	{
+		rec_payload.le_sc_data = &oob_local.le_sc_data;
+	}
+
+	ch_records.ac = &NFC_NDEF_CH_AC_RECORD_DESC(oob_ac);
+	ch_records.carrier = &NFC_NDEF_LE_OOB_RECORD_DESC(oob_rec);
+	ch_records.cnt = 1;
+
+	int err = nfc_ndef_ch_msg_hs_create(&NFC_NDEF_MSG(hs_msg), &NFC_NDEF_CH_RECORD_DESC(hs_rec),
+										&ch_records);
+	if (err < 0)
+	{
+		return err;
+	}
+
+	*len = sizeof(msg_buf);
+	return nfc_ndef_msg_encode(&NFC_NDEF_MSG(hs_msg), msg_buf, len);
+}
+
+/* Fresh OOB values on the tag */
+static void publish_work_handler(struct k_work *work)
+{
+	uint32_t len;
+	char addr[BT_ADDR_LE_STR_LEN];
+
+	int err = bt_le_oob_get_local(BT_ID_DEFAULT, &oob_local);
+	if (err)
+	{
+		LOG_ERR("Failed to get local OOB data (err %d)", err);
+		return;
+	}
+
+	err = build_message(&len);
+	if (err < 0)
+	{
+		LOG_ERR("Failed to build OOB record (err %d)", err);
+		return;
+	}
+
+	err = tag_publish(msg_buf, len);
+	if (err < 0)
+	{
+		LOG_ERR("Failed to publish OOB record (err %d)", err);
+		return;
+	}
+
+	bt_addr_le_to_str(&oob_local.addr, addr, sizeof(addr));
+	LOG_INF("Tag serves %u byte OOB message for %s%s", len, addr,
+			IS_ENABLED(CONFIG_APP_PAIRING_PASSKEY) ? " (no SC data, passkey pairing)" : "");
+}
+
+static void start_advertising(void)
+{
+	int err = bt_le_adv_start(BT_LE_ADV_CONN_FAST_2, ad, ARRAY_SIZE(ad), NULL, 0);
+	if (err)
+	{
+		LOG_ERR("Advertising failed to start (err %d)", err);
+	}
+}
+
+static void on_connected(struct bt_conn *conn, uint8_t err)
+{
+	if (err)
+	{
+		LOG_ERR("Connection failed (err %u)", err);
+		return;
+	}
+
+	connected_ms = k_uptime_get();
+	if (tap_ms)
+	{
+		LOG_INF("Connected %d ms after the tag was read", (int)(connected_ms - tap_ms));
+	}
+	else
+	{
+		LOG_INF("Connected");
+	}
+}
+
+static void on_disconnected(struct bt_conn *conn, uint8_t reason)
+{
+	LOG_INF("Disconnected (reason %u)", reason);
+
+	/* Whether or not they were used, the OOB values are spent */
+	tap_ms = 0;
+	k_work_submit(&publish_work);
+}
+
+static void on_security_changed(struct bt_conn *conn, bt_security_t level, enum bt_security_err err)
+{
+	int64_t now = k_uptime_get();
+
+	if (err)
+	{
+		LOG_WRN("Security setup failed (level %u, err %d)", level, err);
+		return;
+	}
+
+	LOG_INF("Link encrypted (level %u), %d ms after connecting", level, (int)(now - connected_ms));
+	if (tap_ms)
+	{
+		LOG_INF("Tap to encrypted link: %d ms", (int)(now - tap_ms));
+	}
+}
+
+static void on_recycled(void)
+{
+	start_advertising();
+}
+
+static struct bt_conn_cb connection_callbacks = {
+	.connected = on_connected,
+	.disconnected = on_disconnected,
+	.security_changed = on_security_changed,
+	.recycled = on_recycled,
+};
+
+#if defined(CONFIG_APP_PAIRING_PASSKEY)
+static void display_passkey(struct bt_conn *conn, unsigned int passkey)
+{
+	LOG_INF("Passkey: %06u", passkey);
+}
+#else
+static void oob_data_request(struct bt_conn *conn, struct bt_conn_oob_info *info)
+{
+	/* The phone has our values from the tag, we have none of its */
+	if (info->type == BT_CONN_OOB_LE_SC && (info->lesc.oob_config == BT_CONN_OOB_LOCAL_ONLY ||
+											info->lesc.oob_config == BT_CONN_OOB_BOTH_PEERS))
+	{
+		int err = bt_le_oob_set_sc_data(conn, &oob_local.le_sc_data, NULL);
+		if (err == 0)
+		{
+			return;
+		}
+		LOG_ERR("Failed to set OOB data (err %d)", err);
+	}
+	else
+	{
+		LOG_WRN("OOB data requested the tag can't provide");
+	}
+
+	bt_conn_auth_cancel(conn);
+}
+#endif
+
+static void cancel_authentication(struct bt_conn *conn)
+{
+	LOG_INF("Pairing canceled");
+}
+
+static const struct bt_conn_auth_cb auth_callbacks = {
+#if defined(CONFIG_APP_PAIRING_PASSKEY)
+	.passkey_display = display_passkey,
+#else
+	.oob_data_request = oob_data_request,
+#endif
+	.cancel = cancel_authentication,
+};
+
+int main(void)
+{
+	int err;
+
+#if defined(CONFIG_APP_PAIRING_PASSKEY)
+	err = bt_passkey_set(CONFIG_APP_PASSKEY);
+	if (err)
+	{
+		LOG_ERR("Failed to set passkey (err %d)", err);
+		return -1;
+	}
+#endif
+
+	err = bt_conn_auth_cb_register(&auth_callbacks);
+	if (err)
+	{
+		LOG_ERR("Failed to register authorization callbacks (err %d)", err);
+		return -1;
+	}
+
+	err = bt_conn_cb_register(&connection_callbacks);
+	if (err)
+	{
+		LOG_ERR("Failed to register connection callbacks (err %d)", err);
+		return -1;
+	}
+
+	err = bt_enable(NULL);
+	if (err)
+	{
+		LOG_ERR("Bluetooth init failed (err %d)", err);
+		return -1;
+	}
+	LOG_INF("Bluetooth initialized");
+
+	err = tag_init(on_tag_read);
+	if (err < 0)
+	{
+		LOG_ERR("NFC setup failed (err %d)", err);
+		return -1;
+	}
+
+	k_work_submit(&publish_work);
+	start_advertising();
+
+	while (1)
+	{
+		k_sleep(K_FOREVER);
+	}
+}
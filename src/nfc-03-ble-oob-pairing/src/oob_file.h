@@ -0,0 +1,20 @@
+#ifndef OOB_FILE_H_
+#define OOB_FILE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Host side of the simulated tap, in oob_file_bottom.c: built into the
+ * native simulator runner, so the Zephyr image of each simulated device
+ * can reach the same file on the host
+ */
+
+/* Returns 0 or -EIO. Replaces the file in one rename, so a reader never
+ * sees half a message.
+ */
+int oob_file_write(const char *path, const uint8_t *data, size_t len);
+
+/* Returns the number of bytes read, or -ENOENT */
+int oob_file_read(const char *path, uint8_t *buf, size_t size);
+
+#endif /* OOB_FILE_H_ */
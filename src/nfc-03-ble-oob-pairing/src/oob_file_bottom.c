@@ -0,0 +1,47 @@
+/* Host side of oob_file.h on the POSIX arch. Built into the native
+ * simulator runner, not the Zephyr image, so it can use the host's stdio.
+ * The error codes are the values Zephyr uses, the host's errno.h may
+ * differ.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define OOB_EIO 5
+#define OOB_ENOENT 2
+
+int oob_file_write(const char *path, const uint8_t *data, size_t len)
+{
+	char tmp[256];
+
+	if (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int)sizeof(tmp))
+	{
+		return -OOB_EIO;
+	}
+
+	FILE *f = fopen(tmp, "wb");
+	if (!f)
+	{
+		return -OOB_EIO;
+	}
+
+	size_t n = fwrite(data, 1, len, f);
+	if (fclose(f) != 0 || n != len || rename(tmp, path) != 0)
+	{
+		return -OOB_EIO;
+	}
+	return 0;
+}
+
+int oob_file_read(const char *path, uint8_t *buf, size_t size)
+{
+	FILE *f = fopen(path, "rb");
+	if (!f)
+	{
+		return -OOB_ENOENT;
+	}
+
+	size_t n = fread(buf, 1, size, f);
+	fclose(f);
+	return (int)n;
+}
@@ -0,0 +1,20 @@
+#ifndef TAG_H_
+#define TAG_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Where the NDEF message with the OOB record goes: the T2T tag in
+ * tag_nfc.c, or with CONFIG_APP_OOB_SIM a host file that the simulated
+ * phone (central.c) reads, in tag_sim.c.
+ */
+
+/* Called when a reader has read the message, may run in interrupt context */
+typedef void (*tag_read_cb_t)(void);
+
+int tag_init(tag_read_cb_t on_read);
+
+/* Replaces the message served, copies 'msg' */
+int tag_publish(const uint8_t *msg, size_t len);
+
+#endif /* TAG_H_ */
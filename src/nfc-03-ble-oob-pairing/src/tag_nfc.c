@@ -0,0 +1,55 @@
+#include <zephyr/kernel.h>
+#include <string.h>
+
+#include <nfc_t2t_lib.h>
+
+#include "tag.h"
+
+/* The library serves the payload in place, so it gets its own buffer
+ * that only changes while emulation is stopped
+ */
+static uint8_t nfc_buf[NFC_T2T_MAX_PAYLOAD_SIZE];
+static tag_read_cb_t read_cb;
+static bool started;
+
+static void nfc_event_handler(void *ctx, nfc_t2t_event_t evt, const uint8_t *data, size_t len)
+{
+	ARG_UNUSED(ctx);
+	ARG_UNUSED(data);
+	ARG_UNUSED(len);
+
+	if (evt == NFC_T2T_EVENT_DATA_READ && read_cb)
+	{
+		read_cb();
+	}
+}
+
+int tag_init(tag_read_cb_t on_read)
+{
+	read_cb = on_read;
+	return nfc_t2t_setup(nfc_event_handler, NULL);
+}
+
+int tag_publish(const uint8_t *msg, size_t len)
+{
+	if (len > sizeof(nfc_buf))
+	{
+		return -E2BIG;
+	}
+
+	if (started)
+	{
+		nfc_t2t_emulation_stop();
+	}
+
+	memcpy(nfc_buf, msg, len);
+	int err = nfc_t2t_payload_set(nfc_buf, len);
+	if (err < 0)
+	{
+		return err;
+	}
+
+	err = nfc_t2t_emulation_start();
+	started = err == 0;
+	return err;
+}
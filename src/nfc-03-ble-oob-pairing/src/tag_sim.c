@@ -0,0 +1,21 @@
+#include <zephyr/kernel.h>
+
+#include "oob_file.h"
+#include "tag.h"
+
+/* Built instead of tag_nfc.c with CONFIG_APP_OOB_SIM. BabbleSim has no NFC
+ * field, so the message goes to CONFIG_APP_OOB_SIM_FILE on the host, and
+ * the simulated phone reads it from there when it "taps". Nothing reports
+ * the read back, so the read callback is never called.
+ */
+
+int tag_init(tag_read_cb_t on_read)
+{
+	ARG_UNUSED(on_read);
+	return 0;
+}
+
+int tag_publish(const uint8_t *msg, size_t len)
+{
+	return oob_file_write(CONFIG_APP_OOB_SIM_FILE, msg, len);
+}
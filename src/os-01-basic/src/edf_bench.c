@@ -0,0 +1,131 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+
+#include "rt_task.h"
+
+// Built instead of main.c with overlay-edf.conf. Runs a set of periodic tasks
+// with mixed rates at several CPU loads under three policies, and prints the
+// release jitter and deadline misses of every task as JSON lines:
+//   equal - every task at PRIORITY 5, like thread1/thread2 in main.c
+//   rm    - rate monotonic, a shorter period gets a higher static priority
+//   edf   - PRIORITY 5 for all, earliest deadline first (CONFIG_SCHED_DEADLINE)
+
+#define PRIORITY 5
+#define STACK_SIZE 1024
+#define RUN_MS 3000
+#define START_DELAY_MS 10 // lets main set up every task before the first release
+
+enum mode
+{
+    MODE_EQUAL,
+    MODE_RM,
+    MODE_EDF,
+    MODE_COUNT,
+};
+
+static const char *const mode_names[MODE_COUNT] = {
+    [MODE_EQUAL] = "equal",
+    [MODE_RM] = "rm",
+    [MODE_EDF] = "edf",
+};
+
+// Sorted by period, so the index is also the rate monotonic rank
+static const uint32_t periods_ms[] = {5, 10, 20, 50, 100};
+#define TASK_COUNT ARRAY_SIZE(periods_ms)
+
+static const int loads_pct[] = {50, 75, 90};
+
+static struct rt_task tasks[TASK_COUNT];
+static uint32_t work_us[TASK_COUNT];
+K_THREAD_STACK_ARRAY_DEFINE(task_stacks, TASK_COUNT, STACK_SIZE);
+
+static const char *const task_names[TASK_COUNT] = {"t5ms", "t10ms", "t20ms", "t50ms", "t100ms"};
+
+/* ============== */
+/* Load generator */
+/* ============== */
+
+static uint32_t loops_per_ms;
+
+// Burns CPU time, not wall-clock time: a preempted job still has all of its
+// work left when it gets the CPU back, unlike with k_busy_wait()
+static void burn_us(uint32_t us)
+{
+    uint32_t loops = (uint64_t)loops_per_ms * us / USEC_PER_MSEC;
+    for (volatile uint32_t i = 0; i < loops; i++)
+        ;
+}
+
+static void calibrate(void)
+{
+    const uint32_t loops = 100000;
+    uint32_t start = k_cycle_get_32();
+    for (volatile uint32_t i = 0; i < loops; i++)
+        ;
+    uint32_t us = MAX(k_cyc_to_us_ceil32(k_cycle_get_32() - start), 1);
+    loops_per_ms = (uint64_t)loops * USEC_PER_MSEC / us;
+}
+
+static void task_job(struct rt_task *task)
+{
+    burn_us(work_us[task - tasks]);
+}
+
+/* ==== */
+/* Runs */
+/* ==== */
+
+// Every task gets the same share of the load
+static void run(enum mode mode, int load_pct)
+{
+    int64_t first_release = k_uptime_ticks() + k_ms_to_ticks_ceil64(START_DELAY_MS);
+
+    for (size_t i = 0; i < TASK_COUNT; i++)
+    {
+        uint32_t period_us = periods_ms[i] * USEC_PER_MSEC;
+        int prio = mode == MODE_RM ? PRIORITY + (int)i : PRIORITY;
+
+        work_us[i] = period_us * load_pct / 100 / TASK_COUNT;
+        tasks[i].name = task_names[i];
+        tasks[i].period_us = period_us;
+        tasks[i].job = task_job;
+        rt_task_start(&tasks[i], task_stacks[i], STACK_SIZE, prio,
+                      mode == MODE_EDF ? RT_POLICY_EDF : RT_POLICY_STATIC, first_release);
+    }
+
+    k_msleep(RUN_MS);
+
+    for (size_t i = 0; i < TASK_COUNT; i++)
+    {
+        rt_task_stop(&tasks[i]);
+    }
+
+    for (size_t i = 0; i < TASK_COUNT; i++)
+    {
+        const struct rt_task_stats *s = &tasks[i].stats;
+        printk("{\"policy\":\"%s\",\"load_pct\":%d,\"task\":\"%s\",\"period_ms\":%u,"
+               "\"releases\":%u,\"misses\":%u,\"avg_jitter_us\":%u,\"max_jitter_us\":%u,"
+               "\"max_response_us\":%u}\n",
+               mode_names[mode], load_pct, tasks[i].name, periods_ms[i], s->releases, s->misses,
+               s->releases ? (uint32_t)(s->total_jitter_us / s->releases) : 0, s->max_jitter_us,
+               s->max_response_us);
+    }
+}
+
+int main(void)
+{
+    calibrate();
+    printk("EDF benchmark: %d tasks, %d ms per run, %u loops/ms\n", (int)TASK_COUNT, RUN_MS,
+           loops_per_ms);
+
+    for (size_t l = 0; l < ARRAY_SIZE(loads_pct); l++)
+    {
+        for (int mode = 0; mode < MODE_COUNT; mode++)
+        {
+            run(mode, loads_pct[l]);
+        }
+    }
+
+    printk("EDF benchmark done\n");
+    return 0;
+}
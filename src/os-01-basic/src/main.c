@@ -1,8 +1,11 @@
 #include <zephyr/kernel.h>
 #include <zephyr/sys/printk.h>
 
+#include "thread_stats.h"
+
 #define STACK_SIZE 512
 #define PRIORITY 5
+#define REPORT_PERIOD K_SECONDS(5)
 
 // Declare thread stacks
 K_THREAD_STACK_DEFINE(thread1_stack, STACK_SIZE);
@@ -16,18 +19,11 @@ struct k_thread thread2_data;
 void thread1_entry(void *p1, void *p2, void *p3);
 void thread2_entry(void *p1, void *p2, void *p3);
 
-// Thread pointers to each other for state inspection
-struct k_thread *t1_ptr = &thread1_data;
-struct k_thread *t2_ptr = &thread2_data;
-
 void thread1_entry(void *p1, void *p2, void *p3)
 {
     while (1)
     {
         printk("Thread 1 says hello!\n");
-        char buf[32];
-        printk("Thread 1 state: %s\n", k_thread_state_str(t1_ptr, buf, sizeof(buf)));
-        printk("Thread 2 state: %s\n", k_thread_state_str(t2_ptr, buf, sizeof(buf)));
         k_sleep(K_MSEC(1000));
     }
 }
@@ -37,9 +33,6 @@ void thread2_entry(void *p1, void *p2, void *p3)
     while (1)
     {
         printk("Thread 2 reporting in.\n");
-        char buf[32];
-        printk("Thread 1 state: %s\n", k_thread_state_str(t1_ptr, buf, sizeof(buf)));
-        printk("Thread 2 state: %s\n", k_thread_state_str(t2_ptr, buf, sizeof(buf)));
         k_sleep(K_MSEC(1000));
     }
 }
@@ -47,16 +40,22 @@ void thread2_entry(void *p1, void *p2, void *p3)
 void main(void)
 {
     // Create thread 1
-    k_thread_create(&thread1_data, thread1_stack,
-                    STACK_SIZE, thread1_entry,
-                    NULL, NULL, NULL,
-                    PRIORITY, 0, K_NO_WAIT);
+    k_tid_t t1 = k_thread_create(&thread1_data, thread1_stack,
+                                 STACK_SIZE, thread1_entry,
+                                 NULL, NULL, NULL,
+                                 PRIORITY, 0, K_NO_WAIT);
+    k_thread_name_set(t1, "thread1");
 
     // Create thread 2
-    k_thread_create(&thread2_data, thread2_stack,
-                    STACK_SIZE, thread2_entry,
-                    NULL, NULL, NULL,
-                    PRIORITY, 0, K_NO_WAIT);
+    k_tid_t t2 = k_thread_create(&thread2_data, thread2_stack,
+                                 STACK_SIZE, thread2_entry,
+                                 NULL, NULL, NULL,
+                                 PRIORITY, 0, K_NO_WAIT);
+    k_thread_name_set(t2, "thread2");
 
     printk("Main thread done launching threads.\n");
+
+    // Per-thread CPU %, context switches per second and stack high-water
+    // marks, replacing the per-second k_thread_state_str() prints
+    thread_stats_start(REPORT_PERIOD);
 }
@@ -0,0 +1,87 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+
+#include "periodic.h"
+
+// Built instead of main.c with overlay-periodic.conf. Runs 2, 16 and 64
+// periodic jobs on the single executor thread from ../common/periodic.c,
+// without and with a 10 % tolerance, and compares wakeups and RAM with the
+// thread-per-job layout of main.c (512 byte stack + k_thread per job).
+
+#define THREAD_STACK_SIZE 512 // per-job stack in main.c
+#define RUN_MS 5000
+#define MAX_JOBS 64
+#define TOLERANCE_PCT 10
+
+static const int job_counts[] = {2, 16, 64};
+static const uint32_t periods_ms[] = {1000, 500, 200, 100};
+
+static struct periodic_job jobs[MAX_JOBS];
+
+static void job_fn(struct periodic_job *job)
+{
+    // Stands in for a short periodic task, e.g. reading a sensor
+}
+
+// main.c's two threads both run every second. Beyond that, jobs get a mix of
+// periods and start at different offsets, as independent tasks would.
+static uint32_t job_period(int count, int i)
+{
+    return count == 2 ? 1000 : periods_ms[i % ARRAY_SIZE(periods_ms)];
+}
+
+static void run(int count, uint32_t tolerance_pct)
+{
+    uint32_t thread_wakeups_per_sec = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        uint32_t period = job_period(count, i);
+
+        periodic_job_init(&jobs[i], job_fn, period, period * tolerance_pct / 100);
+        thread_wakeups_per_sec += MSEC_PER_SEC / period;
+    }
+
+    periodic_stats_reset();
+    for (int i = 0; i < count; i++)
+    {
+        periodic_job_start(&jobs[i], (i * 37) % job_period(count, i));
+    }
+
+    k_msleep(RUN_MS);
+
+    for (int i = 0; i < count; i++)
+    {
+        periodic_job_stop(&jobs[i]);
+    }
+
+    struct periodic_stats stats;
+    periodic_stats_get(&stats);
+
+    // Stacks and thread objects of each layout, plus the job structs
+    uint32_t ram_threads =
+        count * (K_THREAD_STACK_LEN(THREAD_STACK_SIZE) + sizeof(struct k_thread));
+    uint32_t ram_executor = K_THREAD_STACK_LEN(PERIODIC_STACK_SIZE) + sizeof(struct k_thread) +
+                            count * sizeof(struct periodic_job);
+
+    printk("{\"jobs\":%d,\"tolerance_pct\":%u,\"wakeups_per_sec\":%u,"
+           "\"thread_per_job_wakeups_per_sec\":%u,\"runs_per_sec\":%u,\"max_late_ms\":%u,"
+           "\"ram_thread_per_job\":%u,\"ram_executor\":%u,\"ram_saved\":%d}\n",
+           count, tolerance_pct, stats.wakeups * MSEC_PER_SEC / RUN_MS, thread_wakeups_per_sec,
+           stats.runs * MSEC_PER_SEC / RUN_MS, stats.max_late_ms, ram_threads, ram_executor,
+           (int)(ram_threads - ram_executor));
+}
+
+int main(void)
+{
+    printk("Periodic executor: %d ms per run\n", RUN_MS);
+
+    for (size_t i = 0; i < ARRAY_SIZE(job_counts); i++)
+    {
+        run(job_counts[i], 0);
+        run(job_counts[i], TOLERANCE_PCT);
+    }
+
+    printk("Periodic executor done\n");
+    return 0;
+}
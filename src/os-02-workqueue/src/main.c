@@ -2,6 +2,13 @@
 #include <zephyr/sys/printk.h>
 #include <string.h>
 
+#include "work_stats.h"
+#include "wq_pool.h"
+
+#define SHORT_ITEMS 5
+#define SHORT_ITEM_PERIOD K_MSEC(20)
+#define BLOCKING_WORK_MS 200
+
 // Define a work item
 static struct k_work my_work;
 
@@ -17,19 +24,160 @@ void work_handler(struct k_work *work)
     printk("Work handler done.\n");
 }
 
+/* ========================================== */
+/* Short items submitted behind the busy loop */
+/* ========================================== */
+
+enum target
+{
+    TARGET_SYSTEM,    // k_work_submit() to the system workqueue
+    TARGET_POOL,      // wq_pool, WQ_CLASS_LATENCY
+    TARGET_POOL_BULK, // wq_pool, WQ_CLASS_BULK (stealing demo)
+};
+
+struct timed_work
+{
+    struct k_work work;       // used with the system workqueue
+    struct wq_pool_work pool; // used with the pool
+    uint32_t submitted;
+    uint32_t latency_us;
+};
+
+static struct timed_work short_items[SHORT_ITEMS];
+static int short_next;
+static enum target short_target;
+static K_SEM_DEFINE(short_done, 0, SHORT_ITEMS);
+
+static void short_record(struct timed_work *item)
+{
+    item->latency_us = k_cyc_to_us_floor32(k_cycle_get_32() - item->submitted);
+    k_sem_give(&short_done);
+}
+
+static void short_sys_handler(struct k_work *work)
+{
+    short_record(CONTAINER_OF(work, struct timed_work, work));
+}
+
+static void short_pool_handler(struct k_work *work)
+{
+    struct wq_pool_work *pool_work = CONTAINER_OF(work, struct wq_pool_work, work);
+    short_record(CONTAINER_OF(pool_work, struct timed_work, pool));
+}
+
+// Submits the short items from interrupt context, so they arrive while the
+// long item is running no matter which thread currently owns the CPU
+static void short_timer_handler(struct k_timer *timer)
+{
+    struct timed_work *item = &short_items[short_next++];
+
+    item->submitted = k_cycle_get_32();
+    if (short_target == TARGET_SYSTEM)
+        work_stats_submit(&item->work);
+    else
+        wq_pool_submit(&item->pool);
+
+    if (short_next == SHORT_ITEMS)
+        k_timer_stop(timer);
+}
+
+K_TIMER_DEFINE(short_timer, short_timer_handler, NULL);
+
+// Call before submitting the long item: once a higher priority workqueue
+// thread starts the loop, this thread may not run again until it is done.
+static void short_items_start(enum target target)
+{
+    short_next = 0;
+    short_target = target;
+    for (int i = 0; i < SHORT_ITEMS; i++)
+    {
+        WORK_STATS_INIT(&short_items[i].work, short_sys_handler);
+        wq_pool_work_init(&short_items[i].pool, short_pool_handler,
+                          target == TARGET_POOL_BULK ? WQ_CLASS_BULK : WQ_CLASS_LATENCY);
+    }
+
+    k_timer_start(&short_timer, SHORT_ITEM_PERIOD, SHORT_ITEM_PERIOD);
+}
+
+static void short_items_report(const char *label)
+{
+    uint32_t max_us = 0;
+    uint32_t total_us = 0;
+    for (int i = 0; i < SHORT_ITEMS; i++)
+    {
+        k_sem_take(&short_done, K_FOREVER);
+    }
+    for (int i = 0; i < SHORT_ITEMS; i++)
+    {
+        max_us = MAX(max_us, short_items[i].latency_us);
+        total_us += short_items[i].latency_us;
+    }
+
+    printk("[%s] short item latency: avg %u us, max %u us\n", label,
+           total_us / SHORT_ITEMS, max_us);
+}
+
+/* ================ */
+/* Pool work items  */
+/* ================ */
+
+static struct wq_pool_work busy_work;
+static struct wq_pool_work blocking_work;
+static struct k_work_sync sync;
+
+static void busy_pool_handler(struct k_work *work)
+{
+    for (volatile int i = 0; i < 5000000; i++)
+        ;
+}
+
+// Stands in for a bulk item that mostly waits, e.g. on flash or a sensor
+static void blocking_pool_handler(struct k_work *work)
+{
+    k_msleep(BLOCKING_WORK_MS);
+}
+
 // Main thread
 void main(void)
 {
     printk("Main thread started.\n");
 
-    // Initialize the work item and associate it with the handler
-    k_work_init(&my_work, work_handler);
-
-    // Submit work item to the system workqueue
-    k_work_submit(&my_work);
+    // Initialize the work item and associate it with the handler. Same as
+    // k_work_init(), plus execution-time statistics (see prj.conf).
+    WORK_STATS_INIT(&my_work, work_handler);
 
+    // 1) Everything on the system workqueue: the short items wait for the loop
+    short_items_start(TARGET_SYSTEM);
+    work_stats_submit(&my_work);
     printk("Work item submitted to system workqueue.\n");
+    short_items_report("system workqueue");
+    k_work_flush(&my_work, &sync);
+
+    // 2) Busy loop on the bulk queue, short items on the latency queue
+    wq_pool_init();
+    wq_pool_work_init(&busy_work, busy_pool_handler, WQ_CLASS_BULK);
+    short_items_start(TARGET_POOL);
+    wq_pool_submit(&busy_work);
+    short_items_report("pool, latency class");
+    k_work_flush(&busy_work.work, &sync);
+
+    // 3) Short bulk items behind a blocking bulk item, without and with stealing
+    wq_pool_work_init(&blocking_work, blocking_pool_handler, WQ_CLASS_BULK);
+    short_items_start(TARGET_POOL_BULK);
+    wq_pool_submit(&blocking_work);
+    short_items_report("pool, bulk class");
+    k_work_flush(&blocking_work.work, &sync);
+
+    wq_pool_stealing_set(true);
+    short_items_start(TARGET_POOL_BULK);
+    wq_pool_submit(&blocking_work);
+    short_items_report("pool, bulk class, stealing");
+    k_work_flush(&blocking_work.work, &sync);
+
+    struct wq_pool_stats stats;
+    wq_pool_stats_get(WQ_CLASS_BACKGROUND, &stats);
+    printk("Background queue ran %u stolen bulk items.\n", stats.stolen);
 
-    // Sleep to allow workqueue thread to process the item
-    k_sleep(K_MSEC(500));
+    // Execution times of the system workqueue items above
+    work_stats_print();
 }
@@ -0,0 +1,188 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/printk.h>
+
+// Benchmark build only (CONFIG_APP_BENCH, see overlay-bench.conf): runs the
+// safe_increment() workload from main.c with four kinds of lock, at several
+// thread counts and priority layouts, and prints one JSON line per run.
+// The printk() is left out of the critical section, it would only measure
+// the console.
+
+#define BENCH_MAX_THREADS 8
+#define BENCH_STACK_SIZE 1024
+#define BENCH_BASE_PRIORITY 5 // below main, so main can always stop a run
+#define BENCH_RUN_MS 1000
+#define BENCH_OUTSIDE_LOOPS 50 // work between two increments
+
+extern const int counter_limit; // main.c
+
+enum lock_kind
+{
+    LOCK_MUTEX,
+    LOCK_SEM,
+    LOCK_SPINLOCK,
+    LOCK_ATOMIC,
+    LOCK_KIND_COUNT,
+};
+
+static const char *const lock_names[LOCK_KIND_COUNT] = {
+    [LOCK_MUTEX] = "mutex",
+    [LOCK_SEM] = "sem",
+    [LOCK_SPINLOCK] = "spinlock",
+    [LOCK_ATOMIC] = "atomic_cas",
+};
+
+static const int thread_counts[] = {1, 2, 4, 8};
+
+struct worker
+{
+    struct k_thread thread;
+    uint32_t ops;
+    uint32_t max_wait_cycles;
+};
+
+K_THREAD_STACK_ARRAY_DEFINE(bench_stacks, BENCH_MAX_THREADS, BENCH_STACK_SIZE);
+static struct worker workers[BENCH_MAX_THREADS];
+
+K_MUTEX_DEFINE(bench_mutex);
+K_SEM_DEFINE(bench_sem, 1, 1);
+static struct k_spinlock bench_lock;
+
+static int bench_counter = 0;
+static atomic_t bench_atomic_counter = ATOMIC_INIT(0);
+static volatile bool stop;
+
+/* =========================== */
+/* One increment per lock kind */
+/* =========================== */
+
+static inline void counter_step(void)
+{
+    bench_counter++;
+    if (bench_counter > counter_limit)
+    {
+        bench_counter = 0;
+    }
+}
+
+static void increment_mutex(void)
+{
+    k_mutex_lock(&bench_mutex, K_FOREVER);
+    counter_step();
+    k_mutex_unlock(&bench_mutex);
+}
+
+static void increment_sem(void)
+{
+    k_sem_take(&bench_sem, K_FOREVER);
+    counter_step();
+    k_sem_give(&bench_sem);
+}
+
+static void increment_spinlock(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&bench_lock);
+    counter_step();
+    k_spin_unlock(&bench_lock, key);
+}
+
+// Lock-free: retry until no other thread changed the counter in between.
+// The time spent retrying is this kind's "wait".
+static void increment_atomic(void)
+{
+    atomic_val_t old;
+    atomic_val_t next;
+
+    do
+    {
+        old = atomic_get(&bench_atomic_counter);
+        next = old >= counter_limit ? 0 : old + 1;
+    } while (!atomic_cas(&bench_atomic_counter, old, next));
+}
+
+static void (*const increment[LOCK_KIND_COUNT])(void) = {
+    [LOCK_MUTEX] = increment_mutex,
+    [LOCK_SEM] = increment_sem,
+    [LOCK_SPINLOCK] = increment_spinlock,
+    [LOCK_ATOMIC] = increment_atomic,
+};
+
+/* ============== */
+/* Worker threads */
+/* ============== */
+
+static void worker_thread(void *p1, void *p2, void *p3)
+{
+    struct worker *w = p1;
+    void (*inc)(void) = p2;
+
+    while (!stop)
+    {
+        uint32_t start = k_cycle_get_32();
+        inc();
+        uint32_t wait = k_cycle_get_32() - start;
+
+        w->ops++;
+        if (wait > w->max_wait_cycles)
+            w->max_wait_cycles = wait;
+
+        for (volatile int i = 0; i < BENCH_OUTSIDE_LOOPS; i++)
+            ;
+    }
+}
+
+// 'mixed' gives every thread its own priority, 'equal' shares one
+static void run(enum lock_kind kind, int threads, bool mixed)
+{
+    stop = false;
+    bench_counter = 0;
+    atomic_set(&bench_atomic_counter, 0);
+
+    for (int i = 0; i < threads; i++)
+    {
+        workers[i].ops = 0;
+        workers[i].max_wait_cycles = 0;
+        k_thread_create(&workers[i].thread, bench_stacks[i], BENCH_STACK_SIZE, worker_thread,
+                        &workers[i], increment[kind], NULL,
+                        BENCH_BASE_PRIORITY + (mixed ? i : 0), 0, K_NO_WAIT);
+    }
+
+    k_msleep(BENCH_RUN_MS);
+    stop = true;
+
+    uint64_t ops = 0;
+    uint32_t min_ops = UINT32_MAX;
+    uint32_t max_wait = 0;
+    for (int i = 0; i < threads; i++)
+    {
+        k_thread_join(&workers[i].thread, K_FOREVER);
+        ops += workers[i].ops;
+        min_ops = MIN(min_ops, workers[i].ops);
+        max_wait = MAX(max_wait, workers[i].max_wait_cycles);
+    }
+
+    // min_thread_ops shows starvation: 0 means a thread never got the lock
+    printk("{\"lock\":\"%s\",\"threads\":%d,\"priorities\":\"%s\",\"cpus\":%u,"
+           "\"ops_per_sec\":%u,\"max_wait_us\":%u,\"min_thread_ops\":%u}\n",
+           lock_names[kind], threads, mixed ? "mixed" : "equal", arch_num_cpus(),
+           (uint32_t)(ops * MSEC_PER_SEC / BENCH_RUN_MS), k_cyc_to_us_ceil32(max_wait),
+           min_ops);
+}
+
+int main(void)
+{
+    printk("Lock benchmark: %u CPU(s), %d ms per run\n", arch_num_cpus(), BENCH_RUN_MS);
+
+    for (int kind = 0; kind < LOCK_KIND_COUNT; kind++)
+    {
+        for (size_t t = 0; t < ARRAY_SIZE(thread_counts); t++)
+        {
+            run(kind, thread_counts[t], false);
+            if (thread_counts[t] > 1)
+                run(kind, thread_counts[t], true);
+        }
+    }
+
+    printk("Lock benchmark done\n");
+    return 0;
+}
@@ -1,6 +1,8 @@
 #include <zephyr/kernel.h>
 #include <zephyr/sys/printk.h>
 
+#include "mutex_prof.h"
+
 #define STACK_SIZE 512
 #define SEM_THREAD_PRIORITY 5
 #define MUTEX_THREAD_PRIORITY 4
@@ -35,18 +37,25 @@ void sem_sender_thread(void)
     }
 }
 
+// The benchmark build (overlay-bench.conf) runs src/lock_bench.c instead, the
+// pipeline build (overlay-pipeline.conf) runs src/pipeline.c
+#if !defined(CONFIG_APP_BENCH) && !defined(CONFIG_APP_PIPELINE)
+
 K_THREAD_DEFINE(sem_recv_id, STACK_SIZE, sem_receiver_thread, NULL, NULL, NULL,
                 SEM_THREAD_PRIORITY, 0, 0);
 
 K_THREAD_DEFINE(sem_send_id, STACK_SIZE, sem_sender_thread, NULL, NULL, NULL,
                 SEM_THREAD_PRIORITY, 0, 0);
 
+#endif /* !CONFIG_APP_BENCH && !CONFIG_APP_PIPELINE */
+
 /* ====================== */
 /* Mutex Example Section  */
 /* ====================== */
 
 // Protect shared access to a counter
 K_MUTEX_DEFINE(counter_mutex);
+MUTEX_PROF_NAME(counter_mutex); // see ../common/mutex_prof.conf
 
 int shared_counter = 0;
 const int counter_limit = 100;
@@ -85,8 +94,12 @@ void mutex_worker_thread_2(void)
     }
 }
 
+#if !defined(CONFIG_APP_BENCH)
+
 K_THREAD_DEFINE(mutex_thread1_id, STACK_SIZE, mutex_worker_thread_1, NULL, NULL, NULL,
                 MUTEX_THREAD_PRIORITY, 0, 0);
 
 K_THREAD_DEFINE(mutex_thread2_id, STACK_SIZE, mutex_worker_thread_2, NULL, NULL, NULL,
                 MUTEX_THREAD_PRIORITY, 0, 0);
+
+#endif /* CONFIG_APP_BENCH */
@@ -0,0 +1,190 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <string.h>
+
+#include "buf_pipe.h"
+
+// Pipeline build only (CONFIG_APP_PIPELINE, see overlay-pipeline.conf): takes
+// the place of the semaphore ping-pong, and moves real data from producers to
+// a consumer. The same stream goes once through a zero-copy buf_pipe and once
+// through a k_msgq, which copies every message in and out, and one JSON line
+// per buffer size compares the two.
+
+#define PIPE_MAX_SIZE 1024
+#define PIPE_BUFFERS 8
+#define PIPE_BATCH PIPE_BUFFERS
+#define PIPE_PRODUCERS 2
+#define PIPE_RUN_BUFFERS 20000
+#define PIPE_STACK_SIZE 1024
+#define PIPE_PRIORITY 5 // producers and consumer share it, see below
+
+static const uint16_t buffer_sizes[] = {16, 64, 256, 1024};
+
+enum pipe_mode
+{
+    MODE_ZERO_COPY,
+    MODE_MSGQ_COPY,
+};
+
+BUF_PIPE_DEFINE(pipe, PIPE_MAX_SIZE, PIPE_BUFFERS);
+
+// Baseline: same depth, every message copied into and out of the queue
+struct copy_msg
+{
+    uint32_t len;
+    uint8_t data[PIPE_MAX_SIZE];
+};
+static char __aligned(4) msgq_buffer[PIPE_BUFFERS * sizeof(struct copy_msg)];
+static struct k_msgq copy_q;
+static struct copy_msg producer_msgs[PIPE_PRODUCERS];
+static struct copy_msg consumer_msg;
+
+K_THREAD_STACK_ARRAY_DEFINE(producer_stacks, PIPE_PRODUCERS, PIPE_STACK_SIZE);
+K_THREAD_STACK_DEFINE(consumer_stack, PIPE_STACK_SIZE);
+static struct k_thread producer_threads[PIPE_PRODUCERS];
+static struct k_thread consumer_thread;
+
+static enum pipe_mode mode;
+static uint16_t size;
+static uint32_t msgq_wakeups;
+static uint32_t errors;
+
+/* ========= */
+/* Producers */
+/* ========= */
+
+// Sends PIPE_RUN_BUFFERS / PIPE_PRODUCERS buffers, then an empty one to
+// tell the consumer it is done
+static void producer(void *p1, void *p2, void *p3)
+{
+    int id = (int)(intptr_t)p1;
+    int count = PIPE_RUN_BUFFERS / PIPE_PRODUCERS;
+
+    for (int i = 0; i <= count; i++)
+    {
+        uint16_t len = i < count ? size : 0;
+
+        if (mode == MODE_ZERO_COPY)
+        {
+            struct buf_pipe_buf *buf = buf_pipe_alloc(&pipe, K_FOREVER);
+            buf->len = len;
+            memset(buf->data, (uint8_t)i, len);
+            buf_pipe_put(&pipe, buf);
+        }
+        else
+        {
+            struct copy_msg *msg = &producer_msgs[id];
+            msg->len = len;
+            memset(msg->data, (uint8_t)i, len);
+            k_msgq_put(&copy_q, msg, K_FOREVER);
+        }
+    }
+}
+
+/* ======== */
+/* Consumer */
+/* ======== */
+
+// Only looks at both ends of every buffer: the point is the transport, not
+// the processing
+static bool check(const uint8_t *data, uint16_t len)
+{
+    return data[0] == data[len - 1];
+}
+
+static void consumer(void *p1, void *p2, void *p3)
+{
+    int done = 0;
+
+    while (done < PIPE_PRODUCERS)
+    {
+        if (mode == MODE_ZERO_COPY)
+        {
+            struct buf_pipe_buf *bufs[PIPE_BATCH];
+            int n = buf_pipe_get_batch(&pipe, bufs, PIPE_BATCH, K_FOREVER);
+
+            for (int i = 0; i < n; i++)
+            {
+                if (bufs[i]->len == 0)
+                    done++;
+                else if (!check(bufs[i]->data, bufs[i]->len))
+                    errors++;
+                buf_pipe_free(&pipe, bufs[i]);
+            }
+        }
+        else
+        {
+            if (k_msgq_num_used_get(&copy_q) == 0)
+                msgq_wakeups++;
+            k_msgq_get(&copy_q, &consumer_msg, K_FOREVER);
+
+            if (consumer_msg.len == 0)
+                done++;
+            else if (!check(consumer_msg.data, consumer_msg.len))
+                errors++;
+        }
+    }
+}
+
+/* ==== */
+/* Runs */
+/* ==== */
+
+// Producers and consumer run at the same priority, so waking the consumer
+// does not preempt a producer: it runs once the producers block on a full
+// pipe, and then drains everything they queued.
+static void run(enum pipe_mode run_mode, uint16_t run_size)
+{
+    mode = run_mode;
+    size = run_size;
+    msgq_wakeups = 0;
+    errors = 0;
+    buf_pipe_stats_reset(&pipe);
+    k_msgq_init(&copy_q, msgq_buffer, sizeof(uint32_t) + run_size, PIPE_BUFFERS);
+
+    uint32_t start = k_cycle_get_32();
+
+    k_thread_create(&consumer_thread, consumer_stack, PIPE_STACK_SIZE, consumer, NULL, NULL,
+                    NULL, PIPE_PRIORITY, 0, K_NO_WAIT);
+    for (int i = 0; i < PIPE_PRODUCERS; i++)
+    {
+        k_thread_create(&producer_threads[i], producer_stacks[i], PIPE_STACK_SIZE, producer,
+                        (void *)(intptr_t)i, NULL, NULL, PIPE_PRIORITY, 0, K_NO_WAIT);
+    }
+
+    for (int i = 0; i < PIPE_PRODUCERS; i++)
+    {
+        k_thread_join(&producer_threads[i], K_FOREVER);
+    }
+    k_thread_join(&consumer_thread, K_FOREVER);
+
+    uint32_t us = k_cyc_to_us_ceil32(k_cycle_get_32() - start);
+
+    struct buf_pipe_stats stats;
+    buf_pipe_stats_get(&pipe, &stats);
+    uint32_t buffers = PIPE_RUN_BUFFERS + PIPE_PRODUCERS;
+    uint32_t wakeups = mode == MODE_ZERO_COPY ? stats.wakeups : msgq_wakeups;
+
+    printk("{\"mode\":\"%s\",\"size\":%u,\"buffers_per_sec\":%u,\"wakeups\":%u,"
+           "\"wakeups_per_1000_buffers\":%u,\"max_batch\":%u,\"errors\":%u}\n",
+           mode == MODE_ZERO_COPY ? "zero_copy" : "msgq_copy", size,
+           (uint32_t)((uint64_t)buffers * USEC_PER_SEC / us), wakeups,
+           wakeups * 1000 / buffers, mode == MODE_ZERO_COPY ? stats.max_batch : 1, errors);
+}
+
+int main(void)
+{
+    buf_pipe_init(&pipe);
+
+    printk("Pipeline: %d producers, %d buffers in flight, %d buffers per run\n",
+           PIPE_PRODUCERS, PIPE_BUFFERS, PIPE_RUN_BUFFERS);
+
+    for (size_t i = 0; i < ARRAY_SIZE(buffer_sizes); i++)
+    {
+        run(MODE_ZERO_COPY, buffer_sizes[i]);
+        run(MODE_MSGQ_COPY, buffer_sizes[i]);
+    }
+
+    printk("Pipeline done\n");
+    return 0;
+}
@@ -0,0 +1,236 @@
+#!/usr/bin/env python3
+"""Throughput and latency benchmark for the sdk-01-uart CLI.
+
+Runs against a board on a serial port, or starts the native_sim benchmark
+build itself and attaches to its pty:
+
+    west build -b native_sim -- -DEXTRA_CONF_FILE=overlay-bench.conf
+    python3 scripts/cli_bench.py --exe build/zephyr/zephyr.exe --mix interactive
+
+Measures keystroke echo latency, commands per second for a scripted command
+mix, and collects the device counters ('stats json': TX ring occupancy, drops,
+worst-case RX callback time). The result is one JSON object; with --out it is
+appended as a line to a JSONL file so runs can be compared over time.
+"""
+
+import argparse
+import datetime
+import json
+import random
+import re
+import subprocess
+import sys
+import threading
+import time
+
+from cli_client import PROMPT, CliClient
+
+# Command mixes: (weight, template). {a} and {b} are replaced by random ints.
+MIXES = {
+    "interactive": [
+        (5, "add {a} {b}"),
+        (3, "hello"),
+        (1, "help"),
+        (1, "stats"),
+    ],
+    "add": [
+        (1, "add {a} {b}"),
+    ],
+    "long-lines": [
+        (1, "add {a} {b} " + "x" * 100),
+        (1, "hello " + "y" * 110),
+    ],
+    "slow": [
+        (8, "add {a} {b}"),
+        (1, "sleep 20"),
+    ],
+}
+
+ECHO_TEXT = "the quick brown fox jumps over the lazy dog"
+
+
+def percentile(samples, pct):
+    ordered = sorted(samples)
+    index = min(len(ordered) - 1, int(round(pct / 100.0 * (len(ordered) - 1))))
+    return ordered[index]
+
+
+def summarize_us(samples):
+    if not samples:
+        return {"samples": 0}
+    return {
+        "samples": len(samples),
+        "p50": round(percentile(samples, 50), 1),
+        "p90": round(percentile(samples, 90), 1),
+        "p99": round(percentile(samples, 99), 1),
+        "max": round(max(samples), 1),
+        "mean": round(sum(samples) / len(samples), 1),
+    }
+
+
+def start_native_sim(exe):
+    """Start zephyr.exe and return (process, pty path)."""
+    proc = subprocess.Popen([exe], stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                            text=True, bufsize=1)
+    for line in proc.stdout:
+        match = re.search(r"pseudotty: (\S+)", line)
+        if match:
+            # Keep draining stdout so printk() can never block the simulation
+            threading.Thread(target=lambda: [None for _ in proc.stdout], daemon=True).start()
+            return proc, match.group(1)
+    raise RuntimeError("native_sim exited without reporting its pty")
+
+
+def bench_echo(cli, samples):
+    """Type one character at a time and time its echo."""
+    latencies = []
+    text = (ECHO_TEXT + " ") * (samples // len(ECHO_TEXT) + 1)
+
+    for i in range(samples):
+        char = text[i].encode()
+        start = time.perf_counter()
+        cli.ser.write(char)
+        echo = cli.ser.read(1)
+        if echo != char:
+            raise ValueError("expected echo %r, got %r" % (char, echo))
+        latencies.append((time.perf_counter() - start) * 1e6)
+
+        # Erase every 64 characters so the line buffer never fills up
+        if i % 64 == 63:
+            cli.ser.write(b"\b" * 64)
+            cli.ser.read(3 * 64)
+
+    cli.sync()
+    return latencies
+
+
+def prompts_in_reply(cli, line):
+    """How often PROMPT shows up in the output of 'line' itself.
+
+    'help' and the usage error of a malformed 'add' print "add <num1> <num2>".
+    With several commands in flight, echoed characters can land between a
+    reply and its prompt, so the prompt can't be told apart by a line start.
+    Counting the known occurrences in each reply can.
+    """
+    return sum(l.count(PROMPT.decode()) for l in cli.command(line))
+
+
+def bench_commands(cli, mix, count, window, seed):
+    """Send 'count' commands from 'mix' with up to 'window' in flight."""
+    rng = random.Random(seed)
+    weights = [w for w, _ in mix]
+    templates = [t for _, t in mix]
+    in_reply = {t: prompts_in_reply(cli, t.format(a=1, b=2)) for t in templates}
+    lines = []
+    skips = []
+    for _ in range(count):
+        template = rng.choices(templates, weights)[0]
+        lines.append(template.format(a=rng.randint(-1000, 1000), b=rng.randint(-1000, 1000)))
+        skips.append(in_reply[template])
+
+    sent = 0
+    done = 0
+    skip = skips[0] if count else 0
+    pending = b""
+    deadline_s = 2.0
+    last_progress = time.perf_counter()
+    start = last_progress
+
+    cli.ser.timeout = 0.01
+    try:
+        while done < count:
+            while sent < count and sent - done < window:
+                cli.ser.write(lines[sent].encode() + b"\r")
+                sent += 1
+
+            pending += cli.ser.read(cli.ser.in_waiting or 1)
+            prompts = 0
+            i = pending.find(PROMPT)
+            while i >= 0:
+                pending = pending[i + len(PROMPT):]
+                i = pending.find(PROMPT)
+                if skip:
+                    skip -= 1  # part of the reply
+                    continue
+                done += 1
+                prompts += 1
+                skip = skips[done] if done < count else 0
+            if prompts:
+                last_progress = time.perf_counter()
+            elif time.perf_counter() - last_progress > deadline_s:
+                # Lines dropped by the device never produce a prompt
+                break
+    finally:
+        cli.ser.timeout = 2.0
+
+    elapsed = time.perf_counter() - start
+    cli.sync()
+    return {
+        "count": count,
+        "completed": done,
+        "lost": count - done,
+        "window": window,
+        "seconds": round(elapsed, 4),
+        "per_sec": round(done / elapsed, 1) if elapsed else 0.0,
+    }
+
+
+def device_stats(cli):
+    out = cli.command("stats json")
+    return json.loads(out[-1])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    target = parser.add_mutually_exclusive_group(required=True)
+    target.add_argument("--port", help="serial port or pty of a running target")
+    target.add_argument("--exe", help="native_sim zephyr.exe to start")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--mix", choices=sorted(MIXES), default="interactive")
+    parser.add_argument("--commands", type=int, default=1000)
+    parser.add_argument("--window", type=int, default=1, help="commands in flight")
+    parser.add_argument("--echo-samples", type=int, default=500)
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--label", default="", help="free-form tag stored with the result")
+    parser.add_argument("--out", help="append the result as one JSON line to this file")
+    args = parser.parse_args()
+
+    proc = None
+    port = args.port
+    if args.exe:
+        proc, port = start_native_sim(args.exe)
+
+    try:
+        cli = CliClient(port, args.baud)
+        cli.sync()
+        cli.command("stats reset")
+
+        echo = bench_echo(cli, args.echo_samples)
+        commands = bench_commands(cli, MIXES[args.mix], args.commands, args.window, args.seed)
+        stats = device_stats(cli)
+        cli.close()
+    finally:
+        if proc:
+            proc.terminate()
+            proc.wait()
+
+    result = {
+        "timestamp": datetime.datetime.now(datetime.timezone.utc).isoformat(timespec="seconds"),
+        "label": args.label,
+        "target": "native_sim" if args.exe else port,
+        "mix": args.mix,
+        "echo_latency_us": summarize_us(echo),
+        "commands": commands,
+        "device": stats,
+    }
+
+    json.dump(result, sys.stdout, indent=2)
+    print()
+
+    if args.out:
+        with open(args.out, "a") as f:
+            f.write(json.dumps(result) + "\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+"""Host-side client for the sdk-01-uart CLI.
+
+Talks to the text CLI and to the binary batch protocol (see src/bin_proto.h)
+over a serial port or a native_sim pty, and compares the throughput of
+'add' operations on both paths.
+
+    pip install pyserial
+    python3 cli_client.py --port /dev/pts/3 --ops 5000
+"""
+
+import argparse
+import json
+import random
+import struct
+import sys
+import time
+
+import serial
+
+PROMPT = b"> "
+# Replies can contain PROMPT too ("add <num1> <num2>"), the prompt after a
+# text command always starts a line
+LINE_PROMPT = b"\r\n" + PROMPT
+BINARY_MARKER = b"BINARY MODE\r\n"
+
+BIN_TYPE_BATCH = 1
+BIN_TYPE_EXIT = 2
+
+BIN_OP_ADD = 1
+BIN_OP_SUB = 2
+BIN_OP_MUL = 3
+
+BIN_MAX_OPS = 32
+BIN_CRC_SEED = 0xFFFF
+
+
+def crc16_ccitt(data, seed=BIN_CRC_SEED):
+    """Same algorithm as Zephyr's crc16_ccitt() (reflected 0x1021)."""
+    crc = seed
+    for byte in data:
+        e = (crc ^ byte) & 0xFF
+        f = (e ^ (e << 4)) & 0xFF
+        crc = ((crc >> 8) ^ (f << 8) ^ (f << 3) ^ (f >> 4)) & 0xFFFF
+    return crc
+
+
+def cobs_encode(data):
+    out = bytearray([0])
+    code_pos = 0
+    code = 1
+    for byte in data:
+        if byte == 0:
+            out[code_pos] = code
+            code_pos = len(out)
+            out.append(0)
+            code = 1
+            continue
+        out.append(byte)
+        code += 1
+        if code == 0xFF:
+            out[code_pos] = code
+            code_pos = len(out)
+            out.append(0)
+            code = 1
+    out[code_pos] = code
+    out.append(0)
+    return bytes(out)
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        i += 1
+        if code == 0 or i + code - 1 > len(data):
+            raise ValueError("malformed COBS frame")
+        out += data[i:i + code - 1]
+        i += code - 1
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+class CliClient:
+    def __init__(self, port, baud=115200, timeout=2.0):
+        self.ser = serial.Serial(port, baud, timeout=timeout)
+        self.req_id = 0
+
+    def close(self):
+        self.ser.close()
+
+    def _read_until(self, marker):
+        data = self.ser.read_until(marker)
+        if not data.endswith(marker):
+            raise TimeoutError("timed out waiting for %r, got %r" % (marker, data[-64:]))
+        return data
+
+    def sync(self):
+        """Get to a fresh prompt regardless of what was typed before."""
+        self.ser.reset_input_buffer()
+        self.ser.write(b"\r")
+        self._read_until(LINE_PROMPT)
+
+    def command(self, line):
+        """Run one text command and return its output lines (echo stripped)."""
+        self.ser.write(line.encode() + b"\r")
+        data = self._read_until(LINE_PROMPT)
+        lines = data[:-len(LINE_PROMPT)].decode(errors="replace").split("\r\n")
+        return [l for l in lines[1:] if l]
+
+    def enter_binary(self):
+        self.ser.write(b"binary\r")
+        self._read_until(BINARY_MARKER)
+
+    def _frame(self, frame_type, ops):
+        self.req_id = (self.req_id + 1) & 0xFFFF
+        payload = struct.pack("<HBB", self.req_id, frame_type, len(ops))
+        for opcode, a, b in ops:
+            payload += struct.pack("<Bii", opcode, a, b)
+        payload += struct.pack("<H", crc16_ccitt(payload))
+        self.ser.write(cobs_encode(payload))
+        return self.req_id
+
+    def _response(self, req_id):
+        frame = cobs_decode(self._read_until(b"\x00")[:-1])
+        if len(frame) < 6:
+            raise ValueError("short response frame")
+        if crc16_ccitt(frame[:-2]) != struct.unpack("<H", frame[-2:])[0]:
+            raise ValueError("bad response CRC")
+        rsp_id, status, count = struct.unpack("<HBB", frame[:4])
+        if rsp_id != req_id:
+            raise ValueError("response id %d, expected %d" % (rsp_id, req_id))
+        return status, list(struct.unpack("<%di" % count, frame[4:4 + 4 * count]))
+
+    def batch(self, ops):
+        """Execute up to BIN_MAX_OPS (opcode, a, b) tuples in one frame."""
+        status, results = self._response(self._frame(BIN_TYPE_BATCH, ops))
+        if status != 0:
+            raise ValueError("batch failed with status %d" % status)
+        return results
+
+    def exit_binary(self):
+        self._response(self._frame(BIN_TYPE_EXIT, []))
+        self._read_until(PROMPT)
+
+
+def bench_text(cli, operands):
+    start = time.perf_counter()
+    for a, b in operands:
+        out = cli.command("add %d %d" % (a, b))
+        if not out or int(out[-1]) != a + b:
+            raise ValueError("add %d %d returned %r" % (a, b, out))
+    return time.perf_counter() - start
+
+
+def bench_binary(cli, operands, batch_size):
+    cli.enter_binary()
+    start = time.perf_counter()
+    for i in range(0, len(operands), batch_size):
+        chunk = operands[i:i + batch_size]
+        results = cli.batch([(BIN_OP_ADD, a, b) for a, b in chunk])
+        if results != [a + b for a, b in chunk]:
+            raise ValueError("batch at op %d returned wrong results" % i)
+    elapsed = time.perf_counter() - start
+    cli.exit_binary()
+    return elapsed
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--port", required=True, help="serial port or native_sim pty")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--ops", type=int, default=1000, help="add operations per path")
+    parser.add_argument("--batch", type=int, default=BIN_MAX_OPS, help="ops per binary frame")
+    args = parser.parse_args()
+
+    batch = max(1, min(args.batch, BIN_MAX_OPS))
+    rng = random.Random(1)
+    operands = [(rng.randint(-10000, 10000), rng.randint(-10000, 10000)) for _ in range(args.ops)]
+
+    cli = CliClient(args.port, args.baud)
+    try:
+        cli.sync()
+        text_s = bench_text(cli, operands)
+        bin_s = bench_binary(cli, operands, batch)
+    finally:
+        cli.close()
+
+    report = {
+        "ops": args.ops,
+        "batch": batch,
+        "text": {"seconds": round(text_s, 4), "ops_per_sec": round(args.ops / text_s, 1)},
+        "binary": {"seconds": round(bin_s, 4), "ops_per_sec": round(args.ops / bin_s, 1)},
+    }
+    json.dump(report, sys.stdout, indent=2)
+    print()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,278 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <string.h>
+
+#include "bin_proto.h"
+#include "cli.h"
+#include "uart_io.h"
+
+#define BIN_HDR_SIZE 4
+#define BIN_CRC_SIZE 2
+#define BIN_OP_SIZE 9
+#define BIN_REQ_MAX (BIN_HDR_SIZE + BIN_MAX_OPS * BIN_OP_SIZE + BIN_CRC_SIZE)
+#define BIN_RSP_MAX (BIN_HDR_SIZE + BIN_MAX_OPS * sizeof(int32_t) + BIN_CRC_SIZE)
+
+// COBS adds one byte per started block of 254 bytes
+#define COBS_MAX(len) ((len) + ((len) + 253) / 254)
+
+#define BIN_ENC_MAX COBS_MAX(BIN_REQ_MAX)
+#define BIN_FRAME_QUEUE_SIZE 4
+#define BIN_THREAD_STACK_SIZE 1024
+#define BIN_THREAD_PRIORITY 7
+#define BIN_CRC_SEED 0xffff
+
+struct bin_frame
+{
+    uint16_t len;
+    uint8_t data[BIN_ENC_MAX];
+};
+
+// Encoded frames collected in the UART callback, decoded and executed on
+// the protocol thread
+K_MSGQ_DEFINE(bin_frame_msgq, sizeof(struct bin_frame), BIN_FRAME_QUEUE_SIZE, 4);
+
+static struct bin_frame rx_frame;
+static bool rx_overflow = false;
+
+static struct bin_stats stats;
+
+// -----------------------------------------------------------------------------
+// COBS
+// -----------------------------------------------------------------------------
+
+// Returns the decoded length, or -EINVAL on a malformed frame
+static int cobs_decode(const uint8_t *in, size_t len, uint8_t *out, size_t out_size)
+{
+    size_t r = 0;
+    size_t w = 0;
+
+    while (r < len)
+    {
+        uint8_t code = in[r++];
+        if (code == 0 || r + code - 1 > len)
+            return -EINVAL;
+
+        for (uint8_t i = 1; i < code; i++)
+        {
+            if (w >= out_size)
+                return -EINVAL;
+            out[w++] = in[r++];
+        }
+
+        // A block shorter than 254 implies a zero, except at the very end
+        if (code < 0xff && r < len)
+        {
+            if (w >= out_size)
+                return -EINVAL;
+            out[w++] = 0;
+        }
+    }
+
+    return w;
+}
+
+// Encodes and appends the 0x00 delimiter. Returns the encoded length.
+static size_t cobs_encode(const uint8_t *in, size_t len, uint8_t *out)
+{
+    size_t code_pos = 0;
+    size_t w = 1;
+    uint8_t code = 1;
+
+    for (size_t r = 0; r < len; r++)
+    {
+        if (in[r] == 0)
+        {
+            out[code_pos] = code;
+            code_pos = w++;
+            code = 1;
+            continue;
+        }
+
+        out[w++] = in[r];
+        if (++code == 0xff)
+        {
+            out[code_pos] = code;
+            code_pos = w++;
+            code = 1;
+        }
+    }
+
+    out[code_pos] = code;
+    out[w++] = 0;
+    return w;
+}
+
+// -----------------------------------------------------------------------------
+// RX (runs in the UART callback)
+// -----------------------------------------------------------------------------
+
+static void bin_rx(const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        uint8_t b = data[i];
+
+        if (b != 0)
+        {
+            if (rx_frame.len < sizeof(rx_frame.data))
+                rx_frame.data[rx_frame.len++] = b;
+            else
+                rx_overflow = true;
+            continue;
+        }
+
+        // Delimiter: hand over the frame, skip empty ones used for resync
+        if (rx_overflow || (rx_frame.len > 0 &&
+                            k_msgq_put(&bin_frame_msgq, &rx_frame, K_NO_WAIT) != 0))
+        {
+            stats.frames_dropped++;
+        }
+
+        rx_frame.len = 0;
+        rx_overflow = false;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Frame processing
+// -----------------------------------------------------------------------------
+
+static int32_t run_op(uint8_t opcode, int32_t a, int32_t b, bool *ok)
+{
+    switch (opcode)
+    {
+    case BIN_OP_ADD:
+        return (int32_t)((uint32_t)a + (uint32_t)b);
+    case BIN_OP_SUB:
+        return (int32_t)((uint32_t)a - (uint32_t)b);
+    case BIN_OP_MUL:
+        return (int32_t)((uint32_t)a * (uint32_t)b);
+    default:
+        *ok = false;
+        return 0;
+    }
+}
+
+static void send_response(uint8_t *rsp, size_t len)
+{
+    static uint8_t enc[COBS_MAX(BIN_RSP_MAX) + 1];
+
+    sys_put_le16(crc16_ccitt(BIN_CRC_SEED, rsp, len), &rsp[len]);
+    len += BIN_CRC_SIZE;
+
+    uart_io_write(enc, cobs_encode(rsp, len, enc));
+}
+
+// Returns true if the frame asked to leave binary mode
+static bool handle_frame(const struct bin_frame *frame)
+{
+    static uint8_t req[BIN_REQ_MAX];
+    static uint8_t rsp[BIN_RSP_MAX];
+
+    int len = cobs_decode(frame->data, frame->len, req, sizeof(req));
+    if (len < BIN_HDR_SIZE + BIN_CRC_SIZE)
+    {
+        // Not even a header to answer to
+        stats.frames_dropped++;
+        return false;
+    }
+
+    uint16_t req_id = sys_get_le16(&req[0]);
+    uint8_t type = req[2];
+    uint8_t count = req[3];
+    uint8_t status = BIN_STATUS_OK;
+    uint8_t results = 0;
+
+    sys_put_le16(req_id, &rsp[0]);
+
+    if (crc16_ccitt(BIN_CRC_SEED, req, len - BIN_CRC_SIZE) != sys_get_le16(&req[len - BIN_CRC_SIZE]))
+    {
+        status = BIN_STATUS_BAD_CRC;
+    }
+    else if (type == BIN_TYPE_BATCH)
+    {
+        if (count > BIN_MAX_OPS || len != BIN_HDR_SIZE + count * BIN_OP_SIZE + BIN_CRC_SIZE)
+        {
+            status = BIN_STATUS_BAD_LENGTH;
+        }
+        else
+        {
+            const uint8_t *op = &req[BIN_HDR_SIZE];
+            uint8_t *out = &rsp[BIN_HDR_SIZE];
+            bool ok = true;
+
+            for (; results < count; results++, op += BIN_OP_SIZE, out += sizeof(int32_t))
+            {
+                int32_t value = run_op(op[0], (int32_t)sys_get_le32(&op[1]),
+                                       (int32_t)sys_get_le32(&op[5]), &ok);
+                sys_put_le32((uint32_t)value, out);
+            }
+
+            if (!ok)
+            {
+                status = BIN_STATUS_BAD_OPCODE;
+                results = 0;
+            }
+            else
+            {
+                stats.ops += count;
+            }
+        }
+    }
+    else if (type != BIN_TYPE_EXIT)
+    {
+        status = BIN_STATUS_BAD_TYPE;
+    }
+
+    rsp[2] = status;
+    rsp[3] = results;
+
+    stats.frames++;
+    if (status != BIN_STATUS_OK)
+        stats.errors++;
+
+    send_response(rsp, BIN_HDR_SIZE + results * sizeof(int32_t));
+
+    return status == BIN_STATUS_OK && type == BIN_TYPE_EXIT;
+}
+
+static void bin_thread(void *p1, void *p2, void *p3)
+{
+    static struct bin_frame frame;
+
+    while (1)
+    {
+        k_msgq_get(&bin_frame_msgq, &frame, K_FOREVER);
+
+        if (handle_frame(&frame))
+        {
+            cli_redirect_set(NULL);
+            print(CLI_PROMPT);
+        }
+    }
+}
+
+K_THREAD_DEFINE(bin_thread_id, BIN_THREAD_STACK_SIZE, bin_thread, NULL, NULL, NULL,
+                BIN_THREAD_PRIORITY, 0, 0);
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+void bin_proto_enter(void)
+{
+    rx_frame.len = 0;
+    rx_overflow = false;
+    cli_redirect_set(bin_rx);
+}
+
+void bin_stats_get(struct bin_stats *out)
+{
+    *out = stats;
+}
+
+void bin_stats_reset(void)
+{
+    memset(&stats, 0, sizeof(stats));
+}
@@ -0,0 +1,59 @@
+#ifndef BIN_PROTO_H_
+#define BIN_PROTO_H_
+
+#include <zephyr/types.h>
+#include <stddef.h>
+
+// Binary batch protocol, entered with the 'binary' CLI command.
+//
+// Every frame is COBS encoded and terminated by a 0x00 byte. Decoded, all
+// fields little-endian:
+//
+//   request:  u16 req_id | u8 type | u8 count | count * op       | u16 crc
+//             op = u8 opcode | i32 a | i32 b
+//   response: u16 req_id | u8 status | u8 count | count * i32 result | u16 crc
+//
+// crc is crc16_ccitt() (seed 0xffff) over everything before it. A response
+// carries one result per op in request order. A BIN_TYPE_EXIT request is
+// acknowledged and switches the UART back to the text CLI.
+
+#define BIN_MAX_OPS 32
+
+enum bin_type
+{
+    BIN_TYPE_BATCH = 1,
+    BIN_TYPE_EXIT = 2,
+};
+
+enum bin_opcode
+{
+    BIN_OP_ADD = 1,
+    BIN_OP_SUB = 2,
+    BIN_OP_MUL = 3,
+};
+
+enum bin_status
+{
+    BIN_STATUS_OK = 0,
+    BIN_STATUS_BAD_CRC = 1,
+    BIN_STATUS_BAD_LENGTH = 2,
+    BIN_STATUS_BAD_TYPE = 3,
+    BIN_STATUS_BAD_OPCODE = 4,
+};
+
+struct bin_stats
+{
+    uint32_t frames;         // frames answered
+    uint32_t ops;            // operations executed
+    uint32_t errors;         // frames answered with a non-OK status
+    uint32_t frames_dropped; // frames lost (queue full or frame too long)
+};
+
+// Switch the UART to binary mode. Bytes are routed to the frame decoder until
+// an EXIT frame is received.
+void bin_proto_enter(void);
+
+void bin_stats_get(struct bin_stats *stats);
+void bin_stats_reset(void);
+
+#endif /* BIN_PROTO_H_ */
@@ -0,0 +1,243 @@
+#include <zephyr/kernel.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "cli.h"
+#include "uart_io.h"
+
+#define CLI_LINE_QUEUE_SIZE 4
+#define CLI_THREAD_STACK_SIZE 2048
+#define CLI_THREAD_PRIORITY 7
+
+struct cli_line
+{
+    uint32_t timestamp; // cycle count when the line was completed
+    char text[CLI_LINE_SIZE];
+};
+
+// Completed lines go from the UART callback to the CLI thread through this
+// queue, so a slow command never blocks reception.
+K_MSGQ_DEFINE(cli_line_msgq, sizeof(struct cli_line), CLI_LINE_QUEUE_SIZE, 4);
+
+static char line_buf[CLI_LINE_SIZE];
+static size_t line_len = 0;
+static bool table_sorted = true;
+static uart_io_rx_cb_t redirect;
+
+static struct cli_stats stats;
+
+// -----------------------------------------------------------------------------
+// Line editor (runs in the UART callback)
+// -----------------------------------------------------------------------------
+
+static void line_submit(void)
+{
+    static struct cli_line line;
+
+    line.timestamp = k_cycle_get_32();
+    memcpy(line.text, line_buf, line_len);
+    line.text[line_len] = '\0';
+
+    if (k_msgq_put(&cli_line_msgq, &line, K_NO_WAIT) == 0)
+    {
+        stats.lines++;
+    }
+    else
+    {
+        stats.lines_dropped++;
+    }
+}
+
+static void rx_char(char c)
+{
+    if (c == '\r' || c == '\n')
+    {
+        print("\r\n");
+        line_submit();
+        line_len = 0;
+    }
+    else if (c == '\b' || c == 127)
+    {
+        if (line_len > 0)
+        {
+            line_len--;
+            print("\b \b");
+        }
+    }
+    else if (isprint((unsigned char)c))
+    {
+        if (line_len >= CLI_LINE_SIZE - 1)
+        {
+            stats.chars_dropped++;
+            return;
+        }
+
+        line_buf[line_len++] = c;
+        uart_io_write((const uint8_t *)&c, 1);
+    }
+}
+
+void cli_rx(const uint8_t *data, size_t len)
+{
+    uart_io_rx_cb_t cb = redirect;
+    if (cb)
+    {
+        cb(data, len);
+        return;
+    }
+
+    for (size_t i = 0; i < len; i++)
+    {
+        rx_char((char)data[i]);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Command table
+// -----------------------------------------------------------------------------
+
+size_t cli_cmd_count(void)
+{
+    int count;
+    STRUCT_SECTION_COUNT(cli_cmd, &count);
+    return count;
+}
+
+const struct cli_cmd *cli_cmd_get(size_t index)
+{
+    struct cli_cmd *cmd;
+    STRUCT_SECTION_GET(cli_cmd, index, &cmd);
+    return cmd;
+}
+
+// strcmp() between a length-delimited key and a NUL terminated name
+static int name_cmp(const char *key, size_t key_len, const char *name)
+{
+    int ret = strncmp(key, name, key_len);
+    if (ret != 0)
+        return ret;
+
+    return name[key_len] == '\0' ? 0 : -1;
+}
+
+const struct cli_cmd *cli_find(const char *name, size_t name_len)
+{
+    size_t lo = 0;
+    size_t hi = cli_cmd_count();
+
+    if (!table_sorted)
+    {
+        for (size_t i = 0; i < hi; i++)
+        {
+            const struct cli_cmd *cmd = cli_cmd_get(i);
+            if (name_cmp(name, name_len, cmd->name) == 0)
+                return cmd;
+        }
+        return NULL;
+    }
+
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        const struct cli_cmd *cmd = cli_cmd_get(mid);
+        int ret = name_cmp(name, name_len, cmd->name);
+
+        if (ret == 0)
+            return cmd;
+        if (ret < 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+
+    return NULL;
+}
+
+// The linker sorts by section name, which should match strcmp() order of the
+// command names. Check once so a toolchain surprise degrades to a linear scan
+// instead of commands going missing.
+static void check_table(void)
+{
+    size_t count = cli_cmd_count();
+
+    for (size_t i = 1; i < count; i++)
+    {
+        if (strcmp(cli_cmd_get(i - 1)->name, cli_cmd_get(i)->name) >= 0)
+        {
+            table_sorted = false;
+            printk("cli: command table not sorted, using linear lookup\n");
+            return;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Dispatcher thread
+// -----------------------------------------------------------------------------
+
+static void dispatch(const char *line)
+{
+    while (*line == ' ')
+        line++;
+
+    if (*line == '\0')
+        return;
+
+    size_t name_len = strcspn(line, " ");
+    const struct cli_cmd *cmd = cli_find(line, name_len);
+    if (!cmd)
+    {
+        print("Unknown command\r\n");
+        return;
+    }
+
+    const char *args = line + name_len;
+    while (*args == ' ')
+        args++;
+
+    cmd->handler(args);
+}
+
+static void cli_thread(void *p1, void *p2, void *p3)
+{
+    static struct cli_line line;
+
+    check_table();
+
+    while (1)
+    {
+        k_msgq_get(&cli_line_msgq, &line, K_FOREVER);
+
+        uint32_t wait_us = k_cyc_to_us_floor32(k_cycle_get_32() - line.timestamp);
+        if (wait_us > stats.max_queue_wait_us)
+            stats.max_queue_wait_us = wait_us;
+
+        dispatch(line.text);
+
+        if (!redirect)
+            print(CLI_PROMPT);
+    }
+}
+
+K_THREAD_DEFINE(cli_thread_id, CLI_THREAD_STACK_SIZE, cli_thread, NULL, NULL, NULL,
+                CLI_THREAD_PRIORITY, 0, 0);
+
+void cli_redirect_set(uart_io_rx_cb_t cb)
+{
+    line_len = 0;
+    redirect = cb;
+}
+
+// -----------------------------------------------------------------------------
+// Statistics
+// -----------------------------------------------------------------------------
+
+void cli_stats_get(struct cli_stats *out)
+{
+    *out = stats;
+}
+
+void cli_stats_reset(void)
+{
+    memset(&stats, 0, sizeof(stats));
+}
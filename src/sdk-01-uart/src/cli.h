@@ -0,0 +1,60 @@
+#ifndef CLI_H_
+#define CLI_H_
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/iterable_sections.h>
+
+#include "uart_io.h"
+
+#define CLI_LINE_SIZE 128
+#define CLI_PROMPT "> "
+
+// Runs on the CLI thread with everything after the command name (leading
+// spaces stripped). May block; RX keeps running in the meantime.
+typedef void (*cli_handler_t)(const char *args);
+
+struct cli_cmd
+{
+    const char *name;
+    const char *help;
+    cli_handler_t handler;
+};
+
+// Register a command. Entries are collected at link time in the cli_cmd
+// iterable section, which the linker sorts by variable name. Since the
+// variable name is derived from the command name, the table ends up sorted
+// by name and lookup is a binary search, no matter how many commands exist.
+// The name must therefore be a valid C identifier.
+#define CLI_CMD_DEFINE(_name, _handler, _help)                \
+    static const STRUCT_SECTION_ITERABLE(cli_cmd, cli_cmd_##_name) = { \
+        .name = #_name,                                        \
+        .help = _help,                                         \
+        .handler = _handler,                                   \
+    }
+
+struct cli_stats
+{
+    uint32_t lines;            // lines handed to the CLI thread
+    uint32_t lines_dropped;    // lines lost because the line queue was full
+    uint32_t chars_dropped;    // characters lost because the line was full
+    uint32_t max_queue_wait_us; // worst-case time a line waited for the CLI thread
+};
+
+// Feed received bytes to the line editor. Meant to be passed to uart_io_init().
+void cli_rx(const uint8_t *data, size_t len);
+
+// Route received bytes to another handler (e.g. a binary protocol) instead
+// of the line editor. Pass NULL to return to the text CLI. While redirected,
+// the CLI does not print its prompt.
+void cli_redirect_set(uart_io_rx_cb_t cb);
+
+// Look up a command by name (name_len bytes, not necessarily NUL terminated).
+const struct cli_cmd *cli_find(const char *name, size_t name_len);
+
+size_t cli_cmd_count(void);
+const struct cli_cmd *cli_cmd_get(size_t index);
+
+void cli_stats_get(struct cli_stats *stats);
+void cli_stats_reset(void);
+
+#endif /* CLI_H_ */
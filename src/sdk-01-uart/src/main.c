@@ -1,144 +1,275 @@
 #include <zephyr/kernel.h>
 #include <zephyr/device.h>
-#include <zephyr/drivers/uart.h>
 #include <zephyr/sys/reboot.h>
 #include <stdlib.h>
 #include <string.h>
-#include <ctype.h>
 
-#define CMD_BUF_SIZE 128
-#define PRINT_MSG_SIZE 128
-#define PRINT_QUEUE_SIZE 8
-#define PROMPT "> "
-
-static const struct device *uart;
-static uint8_t rx_buf[1];
-static char cmd_buf[CMD_BUF_SIZE];
-static size_t cmd_len = 0;
+#include "bin_proto.h"
+#include "cli.h"
+#include "uart_io.h"
+#include "work_stats.h"
 
-K_MSGQ_DEFINE(print_msgq, PRINT_MSG_SIZE, PRINT_QUEUE_SIZE, 4);
-static struct k_work_delayable print_work;
-static void process_command(const char *cmd);
+#define PRINT_MSG_SIZE 128
+#define BENCH_DEFAULT_ROUNDS 10000
+#define JSON_MSG_SIZE 256
 
 // -----------------------------------------------------------------------------
-// Print system
+// Commands
 // -----------------------------------------------------------------------------
 
-static void print_work_handler(struct k_work *work)
+static void cmd_hello(const char *args)
+{
+    print("Hello, world!\r\n");
+}
+CLI_CMD_DEFINE(hello, cmd_hello, "Say hello");
+
+static void cmd_add(const char *args)
+{
+    char *end;
+    long a = strtol(args, &end, 10);
+    if (end == args)
+    {
+        print("Error: usage is add <num1> <num2>\r\n");
+        return;
+    }
+
+    const char *arg2 = end;
+    long b = strtol(arg2, &end, 10);
+    if (end == arg2)
+    {
+        print("Error: usage is add <num1> <num2>\r\n");
+        return;
+    }
+
+    char result[32];
+    snprintf(result, sizeof(result), "%ld\r\n", a + b);
+    print(result);
+}
+CLI_CMD_DEFINE(add, cmd_add, "Add two integers: add <num1> <num2>");
+
+// One line of JSON for scripts/cli_bench.py
+static void print_stats_json(const struct uart_io_stats *io, const struct cli_stats *cli,
+                             const struct bin_stats *bin)
 {
-    char msg[PRINT_MSG_SIZE];
-    while (k_msgq_get(&print_msgq, msg, K_NO_WAIT) == 0)
+    char result[JSON_MSG_SIZE];
+
+    snprintf(result, sizeof(result),
+             "{\"rx\":{\"bytes\":%u,\"events\":%u,\"overruns\":%u,\"no_buffer\":%u,"
+             "\"max_cb_us\":%u},",
+             io->rx_bytes, io->rx_events, io->rx_overruns, io->rx_no_buffer, io->rx_max_cb_us);
+    print(result);
+    snprintf(result, sizeof(result),
+             "\"tx\":{\"bytes\":%u,\"transfers\":%u,\"high_water\":%u,\"ring_size\":%u,"
+             "\"dropped\":%u,\"occupancy\":[",
+             io->tx_bytes, io->tx_transfers, io->tx_high_water, io->tx_ring_size, io->tx_dropped);
+    print(result);
+    for (size_t i = 0; i < UART_IO_OCC_BUCKETS; i++)
     {
-        uart_tx(uart, (const uint8_t *)msg, strlen(msg), 100);
-        k_msleep(2);
+        snprintf(result, sizeof(result), "%s%u", i ? "," : "", io->tx_occupancy[i]);
+        print(result);
     }
+    snprintf(result, sizeof(result),
+             "]},\"cli\":{\"lines\":%u,\"lines_dropped\":%u,\"chars_dropped\":%u,"
+             "\"max_queue_wait_us\":%u},",
+             cli->lines, cli->lines_dropped, cli->chars_dropped, cli->max_queue_wait_us);
+    print(result);
+    snprintf(result, sizeof(result),
+             "\"bin\":{\"frames\":%u,\"ops\":%u,\"errors\":%u,\"frames_dropped\":%u}}\r\n",
+             bin->frames, bin->ops, bin->errors, bin->frames_dropped);
+    print(result);
 }
 
-static void print(const char *str)
+static void cmd_stats(const char *args)
 {
-    if (strlen(str) >= PRINT_MSG_SIZE)
+    if (strcmp(args, "reset") == 0)
+    {
+        uart_io_stats_reset();
+        cli_stats_reset();
+        bin_stats_reset();
         return;
+    }
 
-    char tmp[PRINT_MSG_SIZE];
-    strcpy(tmp, str);
+    struct uart_io_stats io;
+    struct cli_stats cli;
+    struct bin_stats bin;
+    char result[PRINT_MSG_SIZE];
 
-    k_msgq_put(&print_msgq, tmp, K_NO_WAIT);
-    k_work_schedule(&print_work, K_MSEC(1));
-}
+    uart_io_stats_get(&io);
+    cli_stats_get(&cli);
+    bin_stats_get(&bin);
 
-// -----------------------------------------------------------------------------
-// UART callback
-// -----------------------------------------------------------------------------
+    if (strcmp(args, "json") == 0)
+    {
+        print_stats_json(&io, &cli, &bin);
+        return;
+    }
+
+    snprintf(result, sizeof(result),
+             "rx bytes=%u events=%u overruns=%u no_buffer=%u max_cb_us=%u\r\n",
+             io.rx_bytes, io.rx_events, io.rx_overruns, io.rx_no_buffer, io.rx_max_cb_us);
+    print(result);
+    snprintf(result, sizeof(result),
+             "tx bytes=%u transfers=%u high_water=%u/%u dropped=%u\r\n",
+             io.tx_bytes, io.tx_transfers, io.tx_high_water, io.tx_ring_size, io.tx_dropped);
+    print(result);
+    snprintf(result, sizeof(result),
+             "cli lines=%u lines_dropped=%u chars_dropped=%u max_queue_wait_us=%u\r\n",
+             cli.lines, cli.lines_dropped, cli.chars_dropped, cli.max_queue_wait_us);
+    print(result);
+    snprintf(result, sizeof(result),
+             "bin frames=%u ops=%u errors=%u frames_dropped=%u\r\n",
+             bin.frames, bin.ops, bin.errors, bin.frames_dropped);
+    print(result);
+}
+CLI_CMD_DEFINE(stats, cmd_stats, "Show counters: stats [json|reset]");
 
-static void uart_cb(const struct device *dev, struct uart_event *evt, void *user_data)
+// Per-handler execution times of the work items wrapped by work_stats.h
+static void cmd_work(const char *args)
 {
-    ARG_UNUSED(dev);
-    ARG_UNUSED(user_data);
+    if (!IS_ENABLED(CONFIG_APP_WORK_STATS))
+    {
+        print("Error: build with CONFIG_APP_WORK_STATS=y\r\n");
+        return;
+    }
 
-    switch (evt->type)
+    if (strcmp(args, "reset") == 0)
     {
-    case UART_RX_RDY:
-        for (size_t i = 0; i < 1; i++)
-        {
-            char c = evt->data.rx.buf[evt->data.rx.offset + i];
-
-            if (c == '\r' || c == '\n')
-            {
-                cmd_buf[cmd_len] = '\0';
-                process_command(cmd_buf);
-                cmd_len = 0;
-                print(PROMPT);
-            }
-            else if (c == '\b' || c == 127)
-            {
-                if (cmd_len > 0)
-                {
-                    cmd_len--;
-                    print("\b \b");
-                }
-            }
-            else if (isprint((unsigned char)c) && cmd_len < CMD_BUF_SIZE - 1)
-            {
-                cmd_buf[cmd_len++] = c;
-                char echo[2] = {c, '\0'};
-                print(echo);
-            }
-        }
-        break;
+        work_stats_reset();
+        return;
+    }
 
-    case UART_RX_DISABLED:
-        uart_rx_enable(dev, rx_buf, sizeof(rx_buf), 100);
-        break;
+    struct work_stats_handler h;
+    struct work_stats_queue q;
+    char result[PRINT_MSG_SIZE];
 
-    default:
-        break;
+    for (int i = 0; work_stats_handler_get(i, &h); i++)
+    {
+        snprintf(result, sizeof(result),
+                 "work %s runs=%u avg_us=%u max_us=%u over_budget=%u wait_max_us=%u "
+                 "hist=%u/%u/%u/%u/%u/%u\r\n",
+                 h.name, h.runs, h.runs ? (uint32_t)(h.total_us / h.runs) : 0, h.max_us,
+                 h.over_budget, h.max_wait_us, h.hist[0], h.hist[1], h.hist[2], h.hist[3],
+                 h.hist[4], h.hist[5]);
+        print(result);
+    }
+    for (int i = 0; work_stats_queue_get(i, &q); i++)
+    {
+        snprintf(result, sizeof(result), "queue %s depth=%u max_depth=%u\r\n",
+                 work_stats_queue_name(q.queue), q.depth, q.max_depth);
+        print(result);
     }
 }
+CLI_CMD_DEFINE(work, cmd_work, "Work item execution times: work [reset]");
 
-// -----------------------------------------------------------------------------
-// Command processing
-// -----------------------------------------------------------------------------
-
-static void process_command(const char *cmd)
+static void cmd_help(const char *args)
 {
-    if (strncmp(cmd, "hello", 5) == 0)
+    char line[PRINT_MSG_SIZE];
+    size_t count = cli_cmd_count();
+
+    for (size_t i = 0; i < count; i++)
     {
-        print("\r\nHello, world!\r\n");
+        const struct cli_cmd *cmd = cli_cmd_get(i);
+        snprintf(line, sizeof(line), "%-8s %s\r\n", cmd->name, cmd->help);
+        print(line);
     }
-    else if (strncmp(cmd, "add ", 4) == 0)
+}
+CLI_CMD_DEFINE(help, cmd_help, "List commands");
+
+#if defined(CONFIG_APP_BENCH)
+
+// Simulates a long-running command. RX and echo keep working while it runs,
+// which 'stats' confirms through rx max_cb_us.
+static void cmd_sleep(const char *args)
+{
+    int ms = atoi(args);
+    if (ms <= 0)
     {
-        char cmd_copy[CMD_BUF_SIZE];
-        strncpy(cmd_copy, cmd, CMD_BUF_SIZE);
-        cmd_copy[CMD_BUF_SIZE - 1] = '\0';
+        print("Error: usage is sleep <ms>\r\n");
+        return;
+    }
 
-        char *arg1 = NULL, *arg2 = NULL, *rest = NULL;
-        arg1 = strtok_r(cmd_copy + 4, " ", &rest);
-        arg2 = strtok_r(NULL, " ", &rest);
+    k_msleep(ms);
+}
+CLI_CMD_DEFINE(sleep, cmd_sleep, "Block the CLI thread: sleep <ms>");
 
-        if (arg1 && arg2)
-        {
-            int a = strtol(arg1, NULL, 10);
-            int b = strtol(arg2, NULL, 10);
+static struct k_work spin_work;
+static uint32_t spin_us;
 
-            char result[32];
-            snprintf(result, sizeof(result), "\r\n%d\r\n", a + b);
-            print(result);
-        }
-        else
-        {
-            print("Error: usage is add <num1> <num2>\r\n");
-        }
-    }
-    else if (strncmp(cmd, "reboot", 6) == 0)
+static void spin_handler(struct k_work *work)
+{
+    k_busy_wait(spin_us);
+}
+
+// Runs a busy loop on the system workqueue, to trip the long-item detector
+static void cmd_spin(const char *args)
+{
+    int us = atoi(args);
+    if (us <= 0)
     {
-        k_sleep(K_MSEC(100));
-        sys_reboot(SYS_REBOOT_COLD);
+        print("Error: usage is spin <us>\r\n");
+        return;
     }
-    else
+
+    spin_us = us;
+    work_stats_submit(&spin_work);
+}
+CLI_CMD_DEFINE(spin, cmd_spin, "Busy work item on the system workqueue: spin <us>");
+
+// Measures command lookup throughput over every registered name plus a miss
+static void cmd_bench(const char *args)
+{
+    int rounds = atoi(args);
+    if (rounds <= 0)
+        rounds = BENCH_DEFAULT_ROUNDS;
+
+    size_t count = cli_cmd_count();
+    uint32_t lookups = 0;
+    uint32_t misses = 0;
+    uint32_t start = k_cycle_get_32();
+
+    for (int r = 0; r < rounds; r++)
     {
-        print("Unknown command\r\n");
+        for (size_t i = 0; i < count; i++)
+        {
+            const char *name = cli_cmd_get(i)->name;
+            if (cli_find(name, strlen(name)) == NULL)
+                misses++;
+        }
+
+        if (cli_find("nosuchcmd", 9) != NULL)
+            misses++;
+
+        lookups += count + 1;
     }
+
+    uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+    char result[PRINT_MSG_SIZE];
+    snprintf(result, sizeof(result),
+             "bench commands=%zu lookups=%u us=%u lookups_per_sec=%u errors=%u\r\n",
+             count, lookups, us,
+             us ? (uint32_t)((uint64_t)lookups * USEC_PER_SEC / us) : 0, misses);
+    print(result);
+}
+CLI_CMD_DEFINE(bench, cmd_bench, "Benchmark command lookup: bench [rounds]");
+
+#endif /* CONFIG_APP_BENCH */
+
+// Hand the UART to the binary batch protocol (see bin_proto.h). The host
+// must wait for the marker line before sending its first frame, so switch
+// first: a frame sent right after the marker must not reach the line editor.
+static void cmd_binary(const char *args)
+{
+    bin_proto_enter();
+    print("BINARY MODE\r\n");
+}
+CLI_CMD_DEFINE(binary, cmd_binary, "Switch to the binary batch protocol");
+
+static void cmd_reboot(const char *args)
+{
+    k_sleep(K_MSEC(100));
+    sys_reboot(SYS_REBOOT_COLD);
 }
+CLI_CMD_DEFINE(reboot, cmd_reboot, "Cold reboot");
 
 // -----------------------------------------------------------------------------
 // Main
@@ -146,17 +277,17 @@ static void process_command(const char *cmd)
 
 int main(void)
 {
-    k_work_init_delayable(&print_work, print_work_handler);
+    const struct device *uart = DEVICE_DT_GET(DT_NODELABEL(uart0));
 
-    uart = DEVICE_DT_GET(DT_NODELABEL(uart0));
-    if (!device_is_ready(uart))
+    if (uart_io_init(uart, cli_rx) < 0)
         return 0;
 
-    uart_callback_set(uart, uart_cb, NULL);
-    uart_rx_enable(uart, rx_buf, sizeof(rx_buf), 100);
+#if defined(CONFIG_APP_BENCH)
+    WORK_STATS_INIT(&spin_work, spin_handler);
+#endif
 
     print("UART CLI Ready\r\n");
-    print(PROMPT);
+    print(CLI_PROMPT);
 
     while (1)
     {
@@ -0,0 +1,235 @@
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/sys/ring_buffer.h>
+#include <string.h>
+
+#include "uart_io.h"
+
+#define TX_RING_SIZE 1024
+
+// RX buffers handed to the driver in turn. The driver owns at most two of them
+// at a time (current + next), the third gives us slack while one is released.
+#define RX_BUF_SIZE 64
+#define RX_BUF_COUNT 3
+#define RX_TIMEOUT_US 1000
+
+static const struct device *uart;
+static uart_io_rx_cb_t rx_cb;
+static uint8_t rx_bufs[RX_BUF_COUNT][RX_BUF_SIZE];
+static size_t rx_buf_next = 0;
+static size_t rx_bufs_in_use = 0;
+
+// Outgoing bytes are packed back to back in a ring buffer. Only one uart_tx()
+// may be in flight, so the next transfer is started from UART_TX_DONE and
+// covers everything that was queued in the meantime.
+RING_BUF_DECLARE(tx_ring, TX_RING_SIZE);
+static struct k_spinlock tx_lock;
+static bool tx_busy = false;
+
+static struct uart_io_stats stats;
+
+// -----------------------------------------------------------------------------
+// TX
+// -----------------------------------------------------------------------------
+
+static void tx_kick(void)
+{
+    uint8_t *data;
+    uint32_t len;
+
+    k_spinlock_key_t key = k_spin_lock(&tx_lock);
+    if (tx_busy)
+    {
+        k_spin_unlock(&tx_lock, key);
+        return;
+    }
+
+    len = ring_buf_get_claim(&tx_ring, &data, TX_RING_SIZE);
+    if (len == 0)
+    {
+        k_spin_unlock(&tx_lock, key);
+        return;
+    }
+
+    tx_busy = true;
+    stats.tx_bytes += len;
+    stats.tx_transfers++;
+    k_spin_unlock(&tx_lock, key);
+
+    // Called without the lock held, some drivers report TX_DONE synchronously
+    if (uart_tx(uart, data, len, SYS_FOREVER_US) != 0)
+    {
+        key = k_spin_lock(&tx_lock);
+        ring_buf_get_finish(&tx_ring, 0);
+        tx_busy = false;
+        k_spin_unlock(&tx_lock, key);
+    }
+}
+
+static void tx_done(size_t len)
+{
+    k_spinlock_key_t key = k_spin_lock(&tx_lock);
+    ring_buf_get_finish(&tx_ring, len);
+    tx_busy = false;
+    k_spin_unlock(&tx_lock, key);
+
+    tx_kick();
+}
+
+void uart_io_write(const uint8_t *data, size_t len)
+{
+    if (len == 0)
+        return;
+
+    k_spinlock_key_t key = k_spin_lock(&tx_lock);
+    if (ring_buf_space_get(&tx_ring) < len)
+    {
+        stats.tx_dropped += len;
+        k_spin_unlock(&tx_lock, key);
+        return;
+    }
+
+    ring_buf_put(&tx_ring, data, len);
+
+    uint32_t used = ring_buf_size_get(&tx_ring);
+    if (used > stats.tx_high_water)
+        stats.tx_high_water = used;
+
+    if (IS_ENABLED(CONFIG_APP_BENCH))
+        stats.tx_occupancy[(used - 1) * UART_IO_OCC_BUCKETS / TX_RING_SIZE]++;
+    k_spin_unlock(&tx_lock, key);
+
+    tx_kick();
+}
+
+void print(const char *str)
+{
+    uart_io_write((const uint8_t *)str, strlen(str));
+}
+
+// -----------------------------------------------------------------------------
+// RX
+// -----------------------------------------------------------------------------
+
+static uint8_t *rx_buf_alloc(void)
+{
+    if (rx_bufs_in_use >= RX_BUF_COUNT)
+        return NULL;
+
+    uint8_t *buf = rx_bufs[rx_buf_next];
+    rx_buf_next = (rx_buf_next + 1) % RX_BUF_COUNT;
+    rx_bufs_in_use++;
+    return buf;
+}
+
+static int rx_enable(const struct device *dev)
+{
+    // Buffers are always released in the order they were handed out, so after
+    // RX_DISABLED the whole ring is free again.
+    rx_buf_next = 0;
+    rx_bufs_in_use = 0;
+
+    return uart_rx_enable(dev, rx_buf_alloc(), RX_BUF_SIZE, RX_TIMEOUT_US);
+}
+
+static void rx_ready(const uint8_t *data, size_t len)
+{
+    uint32_t start = k_cycle_get_32();
+
+    stats.rx_events++;
+    stats.rx_bytes += len;
+
+    rx_cb(data, len);
+
+    uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+    if (us > stats.rx_max_cb_us)
+        stats.rx_max_cb_us = us;
+}
+
+// -----------------------------------------------------------------------------
+// UART callback
+// -----------------------------------------------------------------------------
+
+static void uart_cb(const struct device *dev, struct uart_event *evt, void *user_data)
+{
+    ARG_UNUSED(user_data);
+
+    switch (evt->type)
+    {
+    case UART_TX_DONE:
+    case UART_TX_ABORTED:
+        // On abort, len is the number of bytes that actually went out
+        tx_done(evt->data.tx.len);
+        break;
+
+    case UART_RX_RDY:
+        rx_ready(&evt->data.rx.buf[evt->data.rx.offset], evt->data.rx.len);
+        break;
+
+    case UART_RX_BUF_REQUEST:
+    {
+        uint8_t *buf = rx_buf_alloc();
+        if (buf)
+        {
+            uart_rx_buf_rsp(dev, buf, RX_BUF_SIZE);
+        }
+        else
+        {
+            stats.rx_no_buffer++;
+        }
+        break;
+    }
+
+    case UART_RX_BUF_RELEASED:
+        if (rx_bufs_in_use > 0)
+            rx_bufs_in_use--;
+        break;
+
+    case UART_RX_STOPPED:
+        stats.rx_overruns++;
+        break;
+
+    case UART_RX_DISABLED:
+        rx_enable(dev);
+        break;
+
+    default:
+        break;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+int uart_io_init(const struct device *dev, uart_io_rx_cb_t cb)
+{
+    if (!device_is_ready(dev))
+        return -ENODEV;
+
+    uart = dev;
+    rx_cb = cb;
+
+    int err = uart_callback_set(uart, uart_cb, NULL);
+    if (err)
+        return err;
+
+    return rx_enable(uart);
+}
+
+void uart_io_stats_get(struct uart_io_stats *out)
+{
+    k_spinlock_key_t key = k_spin_lock(&tx_lock);
+    *out = stats;
+    k_spin_unlock(&tx_lock, key);
+
+    out->tx_ring_size = TX_RING_SIZE;
+}
+
+void uart_io_stats_reset(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&tx_lock);
+    memset(&stats, 0, sizeof(stats));
+    stats.tx_high_water = ring_buf_size_get(&tx_ring);
+    k_spin_unlock(&tx_lock, key);
+}
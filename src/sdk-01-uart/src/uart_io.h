@@ -0,0 +1,45 @@
+#ifndef UART_IO_H_
+#define UART_IO_H_
+
+#include <zephyr/device.h>
+#include <zephyr/types.h>
+#include <stddef.h>
+
+// Called from the UART callback (interrupt context) with each received chunk
+typedef void (*uart_io_rx_cb_t)(const uint8_t *data, size_t len);
+
+// Buckets of the TX ring occupancy histogram, each covering 1/8 of the ring
+#define UART_IO_OCC_BUCKETS 8
+
+struct uart_io_stats
+{
+    // RX
+    uint32_t rx_bytes;        // bytes delivered by UART_RX_RDY
+    uint32_t rx_events;       // number of UART_RX_RDY events
+    uint32_t rx_overruns;     // UART_RX_STOPPED events (overrun, framing, ...)
+    uint32_t rx_no_buffer;    // UART_RX_BUF_REQUEST we could not serve
+    uint32_t rx_max_cb_us;    // worst-case time spent handling one UART_RX_RDY
+
+    // TX
+    uint32_t tx_bytes;        // bytes handed to uart_tx()
+    uint32_t tx_transfers;    // number of uart_tx() calls
+    uint32_t tx_high_water;   // peak ring occupancy in bytes
+    uint32_t tx_dropped;      // bytes rejected because the ring was full
+    uint32_t tx_ring_size;
+
+    // Ring occupancy right after each write (CONFIG_APP_BENCH only)
+    uint32_t tx_occupancy[UART_IO_OCC_BUCKETS];
+};
+
+int uart_io_init(const struct device *dev, uart_io_rx_cb_t rx_cb);
+
+// Queue bytes for transmission. Safe from any context, including the RX callback.
+// A message is either queued whole or dropped whole (and counted).
+void uart_io_write(const uint8_t *data, size_t len);
+
+void print(const char *str);
+
+void uart_io_stats_get(struct uart_io_stats *stats);
+void uart_io_stats_reset(void);
+
+#endif /* UART_IO_H_ */
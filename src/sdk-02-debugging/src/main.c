@@ -1,11 +1,19 @@
 #include <zephyr/kernel.h>
 #include <zephyr/sys/printk.h>
 
+#include "mutex_prof.h"
+#include "trace.h"
+
 #define STACK_SIZE 512
 #define MUTEX_THREAD_PRIORITY 4
 
+// TRACE_MARK() ids, see ../common/trace.conf
+#define MARK_PRINT_START 1
+#define MARK_PRINT_END 2
+
 // Protect shared access to a counter
 K_MUTEX_DEFINE(counter_mutex);
+MUTEX_PROF_NAME(counter_mutex); // see ../common/mutex_prof.conf
 
 int shared_counter = 0;
 const int counter_limit = 100;
@@ -21,7 +29,9 @@ void safe_increment(void)
         shared_counter = 0;
     }
 
+    TRACE_MARK(MARK_PRINT_START, shared_counter);
     printk("[Mutex] Thread %p: counter = %d\n", k_current_get(), shared_counter);
+    TRACE_MARK(MARK_PRINT_END, shared_counter);
 
     k_mutex_unlock(&counter_mutex);
 }